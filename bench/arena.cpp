@@ -0,0 +1,37 @@
+#include "corpus.hpp"
+#include <iostream>
+
+using namespace nbt;
+
+// Compares parse and teardown times of the heap-allocated tree against the arena-backed Document.
+int main(int argc, char** argv) {
+    auto iterations = argc > 1 ? std::stoi(argv[1]) : 200;
+    auto bytes = corpus::chunk();
+
+    double heapParse = 0, heapDestroy = 0;
+    for (int i = 0; i < iterations; i++) {
+        CompoundValue* root = nullptr;
+        heapParse += corpus::timeMs([&] {
+            root = new CompoundValue();
+            auto r = StreamReader(bytes);
+            r.skip(3);
+            root->deserialize(r, TagID::Compound);
+        });
+        heapDestroy += corpus::timeMs([&] { delete root; });
+    }
+
+    double arenaParse = 0, arenaDestroy = 0;
+    for (int i = 0; i < iterations; i++) {
+        auto doc = new Document();
+        arenaParse += corpus::timeMs([&] { loadFromBytes(bytes, *doc); });
+        arenaDestroy += corpus::timeMs([&] { delete doc; });
+    }
+
+    std::cout << std::format("{} bytes x {} iterations", bytes.size(), iterations) << std::endl;
+    std::cout << std::format("heap:  parse {:.4f} ms, destroy {:.4f} ms", heapParse / iterations, heapDestroy / iterations)
+              << std::endl;
+    std::cout << std::format("arena: parse {:.4f} ms, destroy {:.4f} ms", arenaParse / iterations, arenaDestroy / iterations)
+              << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "corpus.hpp"
+#include <AsyncSave.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+using namespace nbt;
+
+// Time a server tick spends saving player-sized files: saveToCompressedFile against an AsyncSaver serializing on
+// the caller or on the workers. Each tick edits and saves a few players out of the whole set, and ticks are 10 ms apart
+// like the ones of a (fast) server, which leaves the workers time to drain the queue.
+int main(int argc, char** argv) {
+    auto ticks = argc > 1 ? std::stoi(argv[1]) : 200;
+    constexpr int players = 64, perTick = 4;
+
+    auto dir = std::filesystem::temp_directory_path() / "nbtpp_bench_async";
+    std::filesystem::create_directories(dir);
+
+    std::vector<CompoundValue> trees;
+    std::vector<std::string> paths;
+    for (int i = 0; i < players; i++) {
+        auto bytes = corpus::player(i + 1);
+        trees.push_back(loadFromBytes(bytes));
+        paths.push_back((dir / std::format("{}.dat", i)).string());
+    }
+
+#ifdef nbtpp_zlib
+    auto compression = Compression::Gzip;
+#else
+    auto compression = Compression::None;
+#endif
+
+    auto run = [&](const char* name, auto&& save, auto&& finish) {
+        std::vector<double> tickTimes;
+        auto total = corpus::timeMs([&] {
+            for (int tick = 0; tick < ticks; tick++) {
+                auto start = std::chrono::steady_clock::now();
+                tickTimes.push_back(corpus::timeMs([&] {
+                    for (int i = 0; i < perTick; i++) {
+                        auto player = (tick * perTick + i) % players;
+                        trees[player].edit("XpLevel")->asSimple()->set(tick);
+                        save(player);
+                    }
+                }));
+                std::this_thread::sleep_until(start + std::chrono::milliseconds(10));
+            }
+            finish();
+        });
+        std::sort(tickTimes.begin(), tickTimes.end());
+        std::cout << std::format("{:<16} tick p50 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms, total {:.1f} ms", name,
+                                 tickTimes[tickTimes.size() / 2], tickTimes[tickTimes.size() * 99 / 100], tickTimes.back(), total)
+                  << std::endl;
+    };
+
+    run("sync", [&](int player) { saveToCompressedFile(paths[player], &trees[player], compression); }, [] {});
+
+    for (auto serializeOn : {SerializeOn::Caller, SerializeOn::Worker}) {
+        AsyncSaveOptions options;
+        options.serializeOn = serializeOn;
+        options.compression = compression;
+        options.maxQueued = 16;
+        AsyncSaver saver(options);
+        run(serializeOn == SerializeOn::Caller ? "async, caller" : "async, snapshot", [&](int player) { saver.save(paths[player], trees[player]); },
+            [&] { saver.flush(); });
+    }
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
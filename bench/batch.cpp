@@ -0,0 +1,61 @@
+#include "corpus.hpp"
+#include <Batch.hpp>
+#include <filesystem>
+#include <iostream>
+
+using namespace nbt;
+
+// Scaling of the batch loader and saver from one thread to every core, over a folder of gzipped player-sized and
+// chunk-sized files like the ones of a world.
+int main(int argc, char** argv) {
+    auto count = argc > 1 ? std::stoi(argv[1]) : 512;
+
+    auto dir = std::filesystem::temp_directory_path() / "nbtpp_bench_batch";
+    std::filesystem::create_directories(dir);
+
+    std::vector<std::unique_ptr<CompoundValue>> trees;
+    std::vector<BatchSave> saves;
+    std::vector<std::string> paths;
+    size_t bytes = 0;
+    for (int i = 0; i < count; i++) {
+        auto data = i % 8 == 0 ? corpus::chunk(i + 1) : corpus::player(i + 1);
+        bytes += data.size();
+        trees.push_back(std::make_unique<CompoundValue>(loadFromBytes(data)));
+        paths.push_back((dir / std::format("{}.dat", i)).string());
+        saves.push_back({paths.back(), trees.back().get()});
+    }
+    auto mb = bytes / 1048576.0;
+
+    auto& pool = ThreadPool::shared();
+    std::cout << std::format("{} files, {:.1f} MB uncompressed, up to {} threads", count, mb, pool.size() + 1) << std::endl;
+
+    double baseLoad = 0, baseSave = 0;
+    for (size_t threads = 1;; threads = std::min(threads * 2, pool.size() + 1)) {
+        BatchOptions options;
+        options.maxThreads = threads;
+
+        auto save = corpus::timeMs([&] {
+            for (auto& result : saveFiles(saves, options, pool))
+                if (!result.ok())
+                    std::abort();
+        });
+        std::atomic<size_t> tags = 0;
+        auto load = corpus::timeMs([&] {
+            auto results = loadFiles(paths, [&](size_t, CompoundValue& tree) { tags += tree.getItems().size(); }, options, pool);
+            for (auto& result : results)
+                if (!result.ok())
+                    std::abort();
+        });
+        if (threads == 1)
+            baseLoad = load, baseSave = save;
+
+        std::cout << std::format("  {:>3} threads  load {:>8.1f} MB/s ({:>4.2f}x)  save {:>8.1f} MB/s ({:>4.2f}x)", threads,
+                                 mb / load * 1000, baseLoad / load, mb / save * 1000, baseSave / save)
+                  << std::endl;
+        if (threads == pool.size() + 1)
+            break;
+    }
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,189 @@
+#include "corpus.hpp"
+#include <iostream>
+
+using namespace nbt;
+
+// the shape of corpus::chunk, bound field by field
+struct Properties {
+    std::string facing;
+    std::string waterlogged;
+    bool operator==(const Properties&) const = default;
+};
+
+struct PaletteEntry {
+    std::string name;
+    std::optional<Properties> properties;
+    bool operator==(const PaletteEntry&) const = default;
+};
+
+struct Section {
+    char y = 0;
+    std::vector<long long> blockStates;
+    std::vector<char> blockLight;
+    std::vector<PaletteEntry> palette;
+    bool operator==(const Section&) const = default;
+};
+
+struct Entity {
+    std::string id;
+    float health = 0;
+    std::vector<double> pos;
+    std::vector<double> motion;
+    std::vector<int> uuid;
+    bool operator==(const Entity&) const = default;
+};
+
+struct Level {
+    int xPos = 0;
+    int zPos = 0;
+    long long lastUpdate = 0;
+    std::string status;
+    std::vector<Section> sections;
+    std::vector<Entity> entities;
+    bool operator==(const Level&) const = default;
+};
+
+struct Chunk {
+    Level level;
+    bool operator==(const Chunk&) const = default;
+};
+
+template <>
+struct nbt::Binding<Properties> {
+    static constexpr auto fields = std::make_tuple(field("facing", &Properties::facing), field("waterlogged", &Properties::waterlogged));
+};
+
+template <>
+struct nbt::Binding<PaletteEntry> {
+    static constexpr auto fields = std::make_tuple(field("Name", &PaletteEntry::name), field("Properties", &PaletteEntry::properties));
+};
+
+template <>
+struct nbt::Binding<Section> {
+    static constexpr auto fields = std::make_tuple(field("Y", &Section::y), field("BlockStates", &Section::blockStates),
+                                                   field("BlockLight", &Section::blockLight), field("Palette", &Section::palette));
+};
+
+template <>
+struct nbt::Binding<Entity> {
+    static constexpr auto fields = std::make_tuple(field("id", &Entity::id), field("Health", &Entity::health), field("Pos", &Entity::pos),
+                                                   field("Motion", &Entity::motion), field("UUID", &Entity::uuid));
+};
+
+template <>
+struct nbt::Binding<Level> {
+    // Heightmaps is left out on purpose so the unknown key gets skipped
+    static constexpr auto fields =
+        std::make_tuple(field("xPos", &Level::xPos), field("zPos", &Level::zPos), field("LastUpdate", &Level::lastUpdate),
+                        field("Status", &Level::status), field("Sections", &Level::sections), field("Entities", &Level::entities));
+};
+
+template <>
+struct nbt::Binding<Chunk> {
+    static constexpr auto fields = std::make_tuple(field("Level", &Chunk::level));
+};
+
+static std::string str(Value* val) {
+    return std::string(std::get<std::pmr::string>(val->asSimple()->get()));
+}
+
+template <typename T>
+static T num(Value* val) {
+    return std::get<T>(val->asSimple()->get());
+}
+
+// what the same conversion looks like by hand on top of the tree
+static Chunk fromTree(CompoundValue& root) {
+    Chunk chunk;
+    auto& level = root.getItems()["Level"]->asCompound()->getItems();
+    chunk.level.xPos = num<int>(level["xPos"]);
+    chunk.level.zPos = num<int>(level["zPos"]);
+    chunk.level.lastUpdate = num<long long>(level["LastUpdate"]);
+    chunk.level.status = str(level["Status"]);
+
+    for (auto item : level["Sections"]->asList()->getItems()) {
+        auto& s = item->asCompound()->getItems();
+        auto& section = chunk.level.sections.emplace_back();
+        section.y = num<char>(s["Y"]);
+        auto& states = s["BlockStates"]->asArray<long long>()->getItems();
+        section.blockStates.assign(states.begin(), states.end());
+        auto& light = s["BlockLight"]->asArray<char>()->getItems();
+        section.blockLight.assign(light.begin(), light.end());
+        for (auto p : s["Palette"]->asList()->getItems()) {
+            auto& e = p->asCompound()->getItems();
+            auto& entry = section.palette.emplace_back();
+            entry.name = str(e["Name"]);
+            if (auto it = e.find("Properties"); it != e.end()) {
+                auto& props = it->second->asCompound()->getItems();
+                entry.properties = Properties {str(props["facing"]), str(props["waterlogged"])};
+            }
+        }
+    }
+
+    for (auto item : level["Entities"]->asList()->getItems()) {
+        auto& e = item->asCompound()->getItems();
+        auto& entity = chunk.level.entities.emplace_back();
+        entity.id = str(e["id"]);
+        entity.health = num<float>(e["Health"]);
+        auto& pos = e["Pos"]->asList()->getNumbers<double>();
+        entity.pos.assign(pos.begin(), pos.end());
+        auto& motion = e["Motion"]->asList()->getNumbers<double>();
+        entity.motion.assign(motion.begin(), motion.end());
+        auto& uuid = e["UUID"]->asArray<int>()->getItems();
+        entity.uuid.assign(uuid.begin(), uuid.end());
+    }
+
+    return chunk;
+}
+
+// Converts chunks into structs through the tree and through the binding, then writes them back out.
+int main(int argc, char** argv) {
+    auto chunks = argc > 1 ? std::stoi(argv[1]) : 256;
+
+    std::vector<std::vector<uint8_t>> corpus;
+    size_t totalBytes = 0;
+    for (int i = 0; i < chunks; i++) {
+        corpus.push_back(corpus::chunk(i + 1));
+        totalBytes += corpus.back().size();
+    }
+
+    std::vector<Chunk> viaTree, viaBinding;
+    auto treeLoad = corpus::timeMs([&] {
+        for (auto& bytes : corpus) {
+            auto root = loadFromBytes(bytes);
+            viaTree.push_back(fromTree(root));
+        }
+    });
+    auto bindingLoad = corpus::timeMs([&] {
+        for (auto& bytes : corpus)
+            viaBinding.push_back(loadStruct<Chunk>(bytes));
+    });
+
+    if (viaTree != viaBinding) {
+        std::cerr << "The binding produced different structs" << std::endl;
+        return 1;
+    }
+
+    size_t written = 0;
+    auto bindingSave = corpus::timeMs([&] {
+        for (auto& chunk : viaBinding)
+            written += saveStruct(chunk).size();
+    });
+
+    for (auto& chunk : viaBinding) {
+        auto bytes = saveStruct(chunk);
+        if (loadStruct<Chunk>(bytes) != chunk) {
+            std::cerr << "Round trip through saveStruct failed" << std::endl;
+            return 1;
+        }
+    }
+
+    auto mb = totalBytes / 1048576.0;
+    std::cout << std::format("{} chunks, {:.1f} MB", chunks, mb) << std::endl;
+    std::cout << std::format("tree load + convert: {:8.2f} ms ({:.0f} MB/s)", treeLoad, mb / treeLoad * 1000) << std::endl;
+    std::cout << std::format("loadStruct:          {:8.2f} ms ({:.0f} MB/s)", bindingLoad, mb / bindingLoad * 1000) << std::endl;
+    std::cout << std::format("saveStruct:          {:8.2f} ms ({:.0f} MB/s)", bindingSave, written / 1048576.0 / bindingSave * 1000)
+              << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "corpus.hpp"
+#include <iostream>
+
+using namespace nbt;
+
+// Element-by-element conversion as done before the bulk path
+template <typename T>
+static void readElementwise(StreamReader& reader, std::vector<T>& out) {
+    for (auto& val : out)
+        reader >> val;
+}
+
+template <typename T>
+static void run(const char* name, size_t count, int iterations) {
+    std::vector<T> values(count);
+    for (size_t i = 0; i < count; i++)
+        values[i] = static_cast<T>(i * 2654435761u);
+
+    auto w = StreamWriter();
+    w.writeArray(std::span<const T>(values));
+    auto bytes = w.getBytes();
+    std::vector<T> out(count);
+
+    auto elementwise = corpus::timeMs([&] {
+        for (int i = 0; i < iterations; i++) {
+            auto r = StreamReader(bytes);
+            readElementwise(r, out);
+        }
+    });
+    auto bulk = corpus::timeMs([&] {
+        for (int i = 0; i < iterations; i++) {
+            auto r = StreamReader(bytes);
+            r.readArray(std::span<T>(out));
+        }
+    });
+    auto writeElementwise = corpus::timeMs([&] {
+        for (int i = 0; i < iterations; i++) {
+            auto writer = StreamWriter();
+            for (auto val : values)
+                writer << val;
+        }
+    });
+    auto writeBulk = corpus::timeMs([&] {
+        for (int i = 0; i < iterations; i++) {
+            auto writer = StreamWriter();
+            writer.writeArray(std::span<const T>(values));
+        }
+    });
+
+    auto mb = double(bytes.size()) * iterations / (1024 * 1024);
+    std::cout << std::format("{:<7} x{:>6}: read {:>8.1f} -> {:>8.1f} MB/s, write {:>8.1f} -> {:>8.1f} MB/s", name, count,
+                             mb / elementwise * 1000, mb / bulk * 1000, mb / writeElementwise * 1000, mb / writeBulk * 1000)
+              << std::endl;
+}
+
+// Compares element-by-element reads/writes with the bulk copy + vectorized byte swap path.
+int main(int argc, char** argv) {
+    auto iterations = argc > 1 ? std::stoi(argv[1]) : 2000;
+    for (auto count : {37, 256, 4096}) {
+        run<int>("int", count, iterations);
+        run<long long>("long", count, iterations);
+        run<float>("float", count, iterations);
+        run<double>("double", count, iterations);
+    }
+
+    // whole LongArray values and double lists through the tree
+    auto longs = LongArrayValue();
+    longs.getItems().resize(4096);
+    auto doubles = ListValue(TagID::Double);
+    for (int i = 0; i < 4096; i++)
+        doubles.appendValues({new SimpleValue(i * 0.5)});
+    for (auto val : std::initializer_list<Value*> {&longs, &doubles}) {
+        auto w = StreamWriter();
+        val->serialize(w);
+        auto bytes = w.getBytes();
+        auto ms = corpus::timeMs([&] {
+            for (int i = 0; i < iterations / 10; i++) {
+                auto r = StreamReader(bytes);
+                if (val == &longs) {
+                    LongArrayValue out;
+                    out.deserialize(r, TagID::LongArray);
+                } else {
+                    ListValue out(TagID::Double);
+                    out.deserialize(r, TagID::List);
+                }
+            }
+        });
+        std::cout << std::format("{} deserialize: {:.1f} MB/s", val == &longs ? "LongArray[4096]" : "List<Double>[4096]",
+                                 double(bytes.size()) * (iterations / 10) / (1024 * 1024) / ms * 1000)
+                  << std::endl;
+    }
+
+    return 0;
+}
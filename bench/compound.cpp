@@ -0,0 +1,130 @@
+#include "corpus.hpp"
+#include <iostream>
+#include <unordered_map>
+
+using namespace nbt;
+
+// counts what the containers allocate
+class CountingResource : public std::pmr::memory_resource {
+  public:
+    size_t bytes = 0;
+    size_t allocations = 0;
+
+  private:
+    void* do_allocate(size_t size, size_t align) override {
+        bytes += size;
+        allocations++;
+        return std::pmr::new_delete_resource()->allocate(size, align);
+    }
+    void do_deallocate(void* ptr, size_t size, size_t align) override {
+        std::pmr::new_delete_resource()->deallocate(ptr, size, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+// the previous compound storage
+struct KeyHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view key) const { return std::hash<std::string_view> {}(key); }
+};
+using HashMap = std::pmr::unordered_map<std::pmr::string, Value*, KeyHash, std::equal_to<>>;
+
+static void collect(Value* val, std::vector<CompoundValue*>& out) {
+    if (val->getID() == TagID::Compound) {
+        out.push_back(val->asCompound());
+        for (auto& [_, child] : val->asCompound()->getItems())
+            collect(child, out);
+    } else if (val->getID() == TagID::List) {
+        for (auto child : val->asList()->getItems())
+            collect(child, out);
+    }
+}
+
+// Compares CompoundMap against the unordered_map it replaced on the compounds of the chunk corpus.
+int main(int argc, char** argv) {
+    auto chunks = argc > 1 ? std::stoi(argv[1]) : 128;
+
+    std::vector<std::vector<uint8_t>> corpus;
+    size_t totalBytes = 0;
+    for (int i = 0; i < chunks; i++) {
+        corpus.push_back(corpus::chunk(i + 1));
+        totalBytes += corpus.back().size();
+    }
+
+    Document doc(1024 * 1024);
+    auto parseTime = corpus::timeMs([&] {
+        for (auto& bytes : corpus)
+            loadFromBytes(bytes, doc);
+    });
+
+    // the tree keeps the order it was read in, so writing it back gives the same bytes
+    for (auto& bytes : corpus) {
+        auto& root = loadFromBytes(bytes, doc);
+        if (saveToBytes(&root) != bytes) {
+            std::cerr << "Re-serialized chunk differs from the input" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<CompoundValue> trees;
+    std::vector<CompoundValue*> compounds;
+    for (auto& bytes : corpus)
+        trees.push_back(loadFromBytes(bytes));
+    for (auto& tree : trees)
+        collect(&tree, compounds);
+
+    size_t small = 0;
+    for (auto c : compounds)
+        small += c->getItems().size() <= CompoundMap::IndexThreshold;
+
+    CountingResource flatMem, hashMem;
+    std::vector<CompoundMap> flat;
+    std::vector<HashMap> hashed;
+    flat.reserve(compounds.size());
+    hashed.reserve(compounds.size());
+    for (auto c : compounds) {
+        auto& f = flat.emplace_back(&flatMem);
+        auto& h = hashed.emplace_back(&hashMem);
+        for (auto& [key, val] : c->getItems()) {
+            f.emplace(key, val);
+            h.emplace(std::pmr::string(key, &hashMem), val);
+        }
+    }
+
+    constexpr int rounds = 20;
+    size_t flatHits = 0, hashHits = 0;
+    auto flatTime = corpus::timeMs([&] {
+        for (int r = 0; r < rounds; r++) {
+            for (size_t i = 0; i < compounds.size(); i++) {
+                for (auto& [key, _] : compounds[i]->getItems())
+                    flatHits += flat[i].find(std::string_view(key)) != flat[i].end();
+            }
+        }
+    });
+    auto hashTime = corpus::timeMs([&] {
+        for (int r = 0; r < rounds; r++) {
+            for (size_t i = 0; i < compounds.size(); i++) {
+                for (auto& [key, _] : compounds[i]->getItems())
+                    hashHits += hashed[i].find(std::string_view(key)) != hashed[i].end();
+            }
+        }
+    });
+
+    if (flatHits != hashHits) {
+        std::cerr << "Lookups disagree" << std::endl;
+        return 1;
+    }
+
+    std::cout << std::format("{} chunks, {:.1f} MB, {} compounds ({} with at most {} keys)", chunks, totalBytes / 1048576.0,
+                             compounds.size(), small, CompoundMap::IndexThreshold)
+              << std::endl;
+    std::cout << std::format("parse into Document: {:.2f} ms ({:.0f} MB/s)", parseTime, totalBytes / 1048576.0 / parseTime * 1000)
+              << std::endl;
+    std::cout << std::format("lookups:  CompoundMap {:.2f} ms, unordered_map {:.2f} ms ({} hits)", flatTime, hashTime, flatHits)
+              << std::endl;
+    std::cout << std::format("memory:   CompoundMap {} KB in {} allocations, unordered_map {} KB in {} allocations",
+                             flatMem.bytes / 1024, flatMem.allocations, hashMem.bytes / 1024, hashMem.allocations)
+              << std::endl;
+
+    return 0;
+}
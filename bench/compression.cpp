@@ -0,0 +1,73 @@
+#include "corpus.hpp"
+#include <iostream>
+
+using namespace nbt;
+
+// Throughput and ratio of every compression backend nbtpp was built with, over a few levels each.
+static std::vector<int> levelsFor(std::string_view backend) {
+    if (backend == "zlib")
+        return {1, 6, 9};
+    if (backend == "libdeflate")
+        return {1, 6, 12};
+    if (backend == "zstd")
+        return {-5, 3, 19};
+    if (backend == "lz4")
+        return {0, 9};
+    return {DefaultLevel};
+}
+
+int main(int argc, char** argv) {
+    auto iterations = argc > 1 ? std::stoi(argv[1]) : 10;
+
+    // a region-sized batch of chunks is what caches mostly hold
+    CompoundValue region;
+    auto chunks = new ListValue(TagID::Compound);
+    for (int i = 0; i < 32; i++) {
+        auto bytes = corpus::chunk(i + 1);
+        auto chunk = new CompoundValue();
+        auto r = StreamReader(bytes);
+        readRoot(r, *chunk);
+        chunks->appendValues({chunk});
+    }
+    region.getItems()["Chunks"] = chunks;
+
+    std::pair<const char*, std::vector<uint8_t>> corpora[] = {
+        {"chunks", saveToBytes(&region)},
+        {"player", corpus::player()},
+    };
+
+    std::cout << std::format("{:<8} {:<11} {:<5} {:>5} {:>8} {:>12} {:>14}", "corpus", "backend", "fmt", "level", "ratio",
+                             "comp MB/s", "decomp MB/s")
+              << std::endl;
+    for (auto& [name, bytes] : corpora) {
+        auto mb = bytes.size() / 1048576.0;
+        for (auto& backend : compressionBackends()) {
+            for (auto format : {Compression::Gzip, Compression::Zlib, Compression::Zstd, Compression::Lz4}) {
+                if (!backend->supports(format))
+                    continue;
+
+                for (auto level : levelsFor(backend->name())) {
+                    std::vector<uint8_t> compressed(backend->compressBound(bytes.size(), format));
+                    size_t len = 0;
+                    double comp = 0, decomp = 0;
+                    for (int i = 0; i < iterations; i++)
+                        comp += corpus::timeMs([&] { len = backend->compress(bytes, compressed, format, level); });
+                    compressed.resize(len);
+                    for (int i = 0; i < iterations; i++) {
+                        decomp += corpus::timeMs([&] {
+                            if (backend->decompress(compressed, format).size() != bytes.size())
+                                std::abort();
+                        });
+                    }
+
+                    std::cout << std::format("{:<8} {:<11} {:<5} {:>5} {:>8.2f} {:>12.1f} {:>14.1f}", name, backend->name(),
+                                             compressionName(format), level, (double)bytes.size() / len,
+                                             mb / (comp / iterations / 1000), mb / (decomp / iterations / 1000))
+                              << std::endl;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,262 @@
+#pragma once
+#include <nbtpp.hpp>
+#include <chrono>
+#include <random>
+#include <format>
+#include <fstream>
+#ifdef nbtpp_zlib
+#include <zlib.h>
+#endif
+
+// Deterministic synthetic corpora shared by the benchmarks.
+namespace corpus {
+    using namespace nbt;
+
+    // roughly the shape of an anvil chunk: sections with block states and palettes, heightmaps, entities
+    inline std::vector<uint8_t> chunk(unsigned seed = 1) {
+        std::mt19937 rng(seed);
+        CompoundValue root;
+        auto level = new CompoundValue();
+        root.getItems()["Level"] = level;
+        auto& items = level->getItems();
+        items["xPos"] = new SimpleValue((int)(rng() % 64));
+        items["zPos"] = new SimpleValue((int)(rng() % 64));
+        items["LastUpdate"] = new SimpleValue((long long)rng());
+        items["Status"] = new SimpleValue("full");
+
+        auto heightmaps = new CompoundValue();
+        for (auto name : {"MOTION_BLOCKING", "MOTION_BLOCKING_NO_LEAVES", "OCEAN_FLOOR", "WORLD_SURFACE"}) {
+            auto arr = new LongArrayValue();
+            arr->getItems().resize(37);
+            for (auto& x : arr->getItems())
+                x = ((long long)rng() << 32) | rng();
+            heightmaps->getItems()[name] = arr;
+        }
+        items["Heightmaps"] = heightmaps;
+
+        auto sections = new ListValue(TagID::Compound);
+        for (int y = 0; y < 16; y++) {
+            auto section = new CompoundValue();
+            auto& s = section->getItems();
+            s["Y"] = new SimpleValue((char)y);
+            auto states = new LongArrayValue();
+            states->getItems().resize(256);
+            for (auto& x : states->getItems())
+                x = ((long long)rng() << 32) | rng();
+            s["BlockStates"] = states;
+            auto light = new ByteArrayValue();
+            light->getItems().resize(2048);
+            for (auto& x : light->getItems())
+                x = (char)rng();
+            s["BlockLight"] = light;
+
+            auto palette = new ListValue(TagID::Compound);
+            for (int i = 0; i < 12; i++) {
+                auto entry = new CompoundValue();
+                entry->getItems()["Name"] = new SimpleValue(std::format("minecraft:block_{}", rng() % 400));
+                if (i % 3 == 0) {
+                    auto props = new CompoundValue();
+                    props->getItems()["facing"] = new SimpleValue("north");
+                    props->getItems()["waterlogged"] = new SimpleValue("false");
+                    entry->getItems()["Properties"] = props;
+                }
+                palette->appendValues({entry});
+            }
+            s["Palette"] = palette;
+            sections->appendValues({section});
+        }
+        items["Sections"] = sections;
+
+        auto entities = new ListValue(TagID::Compound);
+        for (int i = 0; i < 24; i++) {
+            auto entity = new CompoundValue();
+            auto& e = entity->getItems();
+            e["id"] = new SimpleValue("minecraft:zombie");
+            e["Health"] = new SimpleValue(20.0f);
+            auto pos = new ListValue(TagID::Double);
+            auto motion = new ListValue(TagID::Double);
+            for (int j = 0; j < 3; j++) {
+                pos->appendValues({new SimpleValue((double)(rng() % 10000) / 7.0)});
+                motion->appendValues({new SimpleValue((double)(rng() % 100) / 100.0)});
+            }
+            e["Pos"] = pos;
+            e["Motion"] = motion;
+            e["UUID"] = new IntArrayValue({(int)rng(), (int)rng(), (int)rng(), (int)rng()});
+            entities->appendValues({entity});
+        }
+        items["Entities"] = entities;
+
+        return saveToBytes(&root);
+    }
+
+    // player data: inventories with enchanted and named items, abilities, attributes and a recipe book
+    inline std::vector<uint8_t> player(unsigned seed = 1) {
+        std::mt19937 rng(seed);
+        CompoundValue root;
+        auto& items = root.getItems();
+
+        auto makeItems = [&](int count) {
+            auto list = new ListValue(TagID::Compound);
+            for (int i = 0; i < count; i++) {
+                auto item = new CompoundValue();
+                auto& it = item->getItems();
+                it["Slot"] = new SimpleValue((char)i);
+                it["id"] = new SimpleValue(std::format("minecraft:item_{}", rng() % 1000));
+                it["Count"] = new SimpleValue((char)(1 + rng() % 64));
+                if (i % 4 == 0) {
+                    auto tag = new CompoundValue();
+                    tag->getItems()["Damage"] = new SimpleValue((int)(rng() % 1500));
+                    auto enchantments = new ListValue(TagID::Compound);
+                    for (int e = 0; e < 3; e++) {
+                        auto ench = new CompoundValue();
+                        ench->getItems()["id"] = new SimpleValue(std::format("minecraft:enchantment_{}", rng() % 40));
+                        ench->getItems()["lvl"] = new SimpleValue((short)(1 + rng() % 5));
+                        enchantments->appendValues({ench});
+                    }
+                    tag->getItems()["Enchantments"] = enchantments;
+                    auto display = new CompoundValue();
+                    display->getItems()["Name"] = new SimpleValue(std::format("{{\"text\":\"Item {}\"}}", rng()));
+                    tag->getItems()["display"] = display;
+                    it["tag"] = tag;
+                }
+                list->appendValues({item});
+            }
+            return list;
+        };
+        items["Inventory"] = makeItems(36);
+        items["EnderItems"] = makeItems(27);
+
+        auto pos = new ListValue(TagID::Double);
+        auto& p = pos->getNumbers<double>();
+        for (int i = 0; i < 3; i++)
+            p.push_back((double)(rng() % 100000) / 3.0);
+        items["Pos"] = pos;
+        items["Rotation"] = new ListValue(TagID::Float, {new SimpleValue(90.0f), new SimpleValue(12.5f)});
+        items["Health"] = new SimpleValue(20.0f);
+        items["XpLevel"] = new SimpleValue((int)(rng() % 100));
+        items["Dimension"] = new SimpleValue("minecraft:overworld");
+        items["UUID"] = new IntArrayValue({(int)rng(), (int)rng(), (int)rng(), (int)rng()});
+
+        auto abilities = new CompoundValue();
+        for (auto name : {"flying", "instabuild", "invulnerable", "mayBuild", "mayfly"})
+            abilities->getItems()[name] = new SimpleValue((char)(rng() % 2));
+        abilities->getItems()["flySpeed"] = new SimpleValue(0.05f);
+        abilities->getItems()["walkSpeed"] = new SimpleValue(0.1f);
+        items["abilities"] = abilities;
+
+        auto attributes = new ListValue(TagID::Compound);
+        for (int i = 0; i < 8; i++) {
+            auto attr = new CompoundValue();
+            attr->getItems()["Name"] = new SimpleValue(std::format("minecraft:generic.attribute_{}", i));
+            attr->getItems()["Base"] = new SimpleValue((double)(rng() % 20));
+            attributes->appendValues({attr});
+        }
+        items["Attributes"] = attributes;
+
+        auto book = new CompoundValue();
+        for (auto name : {"recipes", "toBeDisplayed"}) {
+            auto recipes = new ListValue(TagID::String);
+            for (int i = 0; i < 600; i++)
+                recipes->appendValues({new SimpleValue(std::format("minecraft:recipe_{}", rng() % 5000))});
+            book->getItems()[name] = recipes;
+        }
+        items["recipeBook"] = book;
+
+        return saveToBytes(&root);
+    }
+
+    // a few huge LongArrays, `longs` values in total
+    inline std::vector<uint8_t> longArrays(size_t longs = 1 << 20, unsigned seed = 1) {
+        std::mt19937_64 rng(seed);
+        CompoundValue root;
+        for (int i = 0; i < 4; i++) {
+            auto arr = new LongArrayValue();
+            arr->getItems().resize(longs / 4);
+            for (auto& x : arr->getItems())
+                x = (long long)rng();
+            root.getItems()[std::format("data{}", i)] = arr;
+        }
+        return saveToBytes(&root);
+    }
+
+    // compounds and single-item lists nested `depth` levels deep, with a few scalars on every level
+    inline std::vector<uint8_t> deep(int depth = 256) {
+        CompoundValue root;
+        auto current = &root;
+        for (int i = 0; i < depth; i++) {
+            auto& items = current->getItems();
+            items["depth"] = new SimpleValue(i);
+            items["name"] = new SimpleValue(std::format("level {}", i));
+            auto child = new CompoundValue();
+            if (i % 2) {
+                items["child"] = child;
+            } else {
+                items["children"] = new ListValue(TagID::Compound, {child});
+            }
+            current = child;
+        }
+        return saveToBytes(&root);
+    }
+
+    // a single compound with `keys` keys of mixed scalar types
+    inline std::vector<uint8_t> wide(int keys = 100000, unsigned seed = 1) {
+        std::mt19937 rng(seed);
+        CompoundValue root;
+        auto& items = root.getItems();
+        for (int i = 0; i < keys; i++) {
+            auto key = std::format("key_{}", i);
+            switch (i % 4) {
+            case 0:
+                items[key] = new SimpleValue((int)rng());
+                break;
+            case 1:
+                items[key] = new SimpleValue((double)rng() / 7.0);
+                break;
+            case 2:
+                items[key] = new SimpleValue(std::format("value {}", rng()));
+                break;
+            default:
+                items[key] = new SimpleValue((char)rng());
+                break;
+            }
+        }
+        return saveToBytes(&root);
+    }
+
+#ifdef nbtpp_zlib
+    // writes a region file with the given amount of zlib-compressed chunks
+    inline void region(const std::string& path, size_t chunks = 1024) {
+        std::vector<uint8_t> header(8192), body;
+        for (size_t i = 0; i < chunks; i++) {
+            auto bytes = chunk(i + 1);
+            std::vector<uint8_t> comp(compressBound(bytes.size()));
+            uLongf compLen = comp.size();
+            compress(comp.data(), &compLen, bytes.data(), bytes.size());
+
+            auto offset = 2 + body.size() / 4096;
+            auto len = compLen + 1;
+            body.insert(body.end(), {uint8_t(len >> 24), uint8_t(len >> 16), uint8_t(len >> 8), uint8_t(len), 2});
+            body.insert(body.end(), comp.begin(), comp.begin() + compLen);
+            body.resize((body.size() + 4095) / 4096 * 4096);
+
+            auto sectors = 2 + body.size() / 4096 - offset;
+            header[i * 4] = offset >> 16;
+            header[i * 4 + 1] = offset >> 8;
+            header[i * 4 + 2] = offset;
+            header[i * 4 + 3] = sectors;
+        }
+
+        std::ofstream f(path, std::ios::binary | std::ios::trunc);
+        f.write((char*)header.data(), header.size());
+        f.write((char*)body.data(), body.size());
+    }
+#endif
+
+    template <typename F>
+    double timeMs(F&& func) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+} // namespace corpus
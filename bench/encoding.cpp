@@ -0,0 +1,40 @@
+#include "corpus.hpp"
+#include <iostream>
+
+using namespace nbt;
+
+// Load and save throughput of the same trees in every encoding. On a little-endian host the Bedrock encoding needs
+// no byte swaps at all, the network one trades them for varints.
+int main(int argc, char** argv) {
+    auto iterations = argc > 1 ? std::stoi(argv[1]) : 200;
+
+    std::pair<const char*, std::vector<uint8_t>> corpora[] = {
+        {"chunk", corpus::chunk()},
+        {"player", corpus::player()},
+        {"longArrays", corpus::longArrays(1 << 18)},
+    };
+
+    Document doc;
+    for (auto& [name, bytes] : corpora) {
+        auto tree = loadFromBytes(bytes);
+        std::cout << std::format("{}:", name) << std::endl;
+        for (auto [encoding, label] : {std::pair {Encoding::Java, "java"}, {Encoding::Bedrock, "bedrock"}, {Encoding::Network, "network"}}) {
+            auto data = saveToBytes(&tree, encoding);
+            auto mb = data.size() / 1048576.0 * iterations;
+
+            auto load = corpus::timeMs([&] {
+                for (int i = 0; i < iterations; i++)
+                    loadFromBytes(data, doc, Trust::Trusted, encoding);
+            });
+            auto save = corpus::timeMs([&] {
+                for (int i = 0; i < iterations; i++)
+                    auto out = saveToBytes(&tree, encoding);
+            });
+
+            std::cout << std::format("  {:<8} {:>9} bytes  load {:>8.1f} MB/s  save {:>8.1f} MB/s", label, data.size(),
+                                     mb / load * 1000, mb / save * 1000)
+                      << std::endl;
+        }
+    }
+    return 0;
+}
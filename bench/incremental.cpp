@@ -0,0 +1,55 @@
+#include "corpus.hpp"
+#include <iostream>
+
+using namespace nbt;
+
+static void edit(CompoundValue& root, int value) {
+    auto chunk = root.getItems()["Chunks"]->asList()->getItems()[17]->asCompound();
+    chunk->getItems()["Level"]->asCompound()->getItems()["xPos"]->asSimple()->set(value);
+}
+
+// Loads a multi-megabyte file, changes one field and saves it: full re-encoding against loadForEditing.
+int main(int argc, char** argv) {
+    auto chunks = argc > 1 ? std::stoi(argv[1]) : 64;
+    auto iterations = argc > 2 ? std::stoi(argv[2]) : 20;
+
+    CompoundValue file;
+    auto list = new ListValue(TagID::Compound);
+    for (int i = 0; i < chunks; i++) {
+        auto bytes = corpus::chunk(i + 1);
+        auto chunk = new CompoundValue();
+        auto r = StreamReader(bytes);
+        r.skip(3);
+        chunk->deserialize(r, TagID::Compound);
+        list->appendValues({chunk});
+    }
+    file.getItems()["Chunks"] = list;
+    auto bytes = saveToBytes(&file);
+
+    Document doc(bytes.size() * 2);
+    double fullLoad = 0, fullSave = 0, editLoad = 0, editSave = 0, editSaveInto = 0;
+    std::vector<uint8_t> full, incremental, reused(bytes.size() + 64);
+    for (int i = 0; i < iterations; i++) {
+        fullLoad += corpus::timeMs([&] { loadFromBytes(bytes, doc); });
+        edit(doc.root(), i);
+        fullSave += corpus::timeMs([&] { full = saveToBytes(&doc.root()); });
+
+        editLoad += corpus::timeMs([&] { loadForEditing(bytes, doc); });
+        edit(doc.root(), i);
+        editSave += corpus::timeMs([&] { incremental = saveToBytes(&doc.root()); });
+        editSaveInto += corpus::timeMs([&] { saveToBytes(&doc.root(), reused); });
+
+        if (full != incremental) {
+            std::cerr << "Incremental save differs from the full one" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << std::format("{:.1f} MB file, one field changed, {} iterations", bytes.size() / 1048576.0, iterations) << std::endl;
+    std::cout << std::format("full:        load {:.3f} ms, save {:.3f} ms", fullLoad / iterations, fullSave / iterations) << std::endl;
+    std::cout << std::format("incremental: load {:.3f} ms, save {:.3f} ms ({:.3f} ms into a reused buffer)", editLoad / iterations,
+                             editSave / iterations, editSaveInto / iterations)
+              << std::endl;
+
+    return 0;
+}
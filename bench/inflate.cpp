@@ -0,0 +1,88 @@
+#include "corpus.hpp"
+#include <fstream>
+#include <iostream>
+#include <zlib.h>
+
+using namespace nbt;
+
+// the loader before streaming: read the whole file, inflate it into a growing string, then parse
+static CompoundValue loadWholeBuffer(const std::string& path, size_t& peakBuffers) {
+    std::ifstream fileStream(path, std::ios::binary);
+    std::vector<char> source((std::istreambuf_iterator<char>(fileStream)), std::istreambuf_iterator<char>());
+
+    z_stream strm {};
+    strm.next_in = (Bytef*)source.data();
+    strm.avail_in = source.size();
+    inflateInit2(&strm, 16 + MAX_WBITS);
+
+    std::string uncomp;
+    while (true) {
+        auto avail = std::min(strm.avail_in, 1024u * 8u);
+        auto prevSize = uncomp.size();
+        uncomp.resize(prevSize + avail);
+        strm.next_out = (Bytef*)(uncomp.data() + prevSize);
+        strm.avail_out = avail;
+        if (inflate(&strm, Z_SYNC_FLUSH) != Z_OK)
+            break;
+    }
+    inflateEnd(&strm);
+
+    peakBuffers = source.size() + uncomp.capacity();
+    return loadFromBytes({(uint8_t*)uncomp.data(), uncomp.size()});
+}
+
+// Compares loading a big gzip file through the old whole-buffer path, the streaming InflateSource and the
+// streaming source running on a background thread.
+int main(int argc, char** argv) {
+    auto chunks = argc > 1 ? std::stoi(argv[1]) : 64;
+    auto iterations = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    CompoundValue big;
+    auto chunkBytes = corpus::chunk();
+    for (int i = 0; i < chunks; i++) {
+        auto chunk = new CompoundValue();
+        auto r = StreamReader(chunkBytes);
+        r.skip(3);
+        chunk->deserialize(r, TagID::Compound);
+        big.getItems()[std::format("chunk{}", i).c_str()] = chunk;
+    }
+    auto path = std::string("bench_inflate.nbt.gz");
+    saveToCompressedFile(path, &big);
+    auto expected = saveToBytes(&big);
+
+    size_t peakBuffers = 0;
+    double whole = 0, streaming = 0, async = 0;
+    for (int i = 0; i < iterations; i++) {
+        whole += corpus::timeMs([&] {
+            auto val = loadWholeBuffer(path, peakBuffers);
+            if (saveToBytes(&val).size() != expected.size())
+                std::cerr << "whole-buffer result mismatch" << std::endl;
+        });
+        streaming += corpus::timeMs([&] {
+            auto val = loadFromCompressedFile(path);
+            if (saveToBytes(&val).size() != expected.size())
+                std::cerr << "streaming result mismatch" << std::endl;
+        });
+        async += corpus::timeMs([&] {
+            auto source = AsyncSource(std::make_unique<InflateSource>(path));
+            auto val = loadFromSource(source);
+            if (saveToBytes(&val).size() != expected.size())
+                std::cerr << "async result mismatch" << std::endl;
+        });
+    }
+
+    std::cout << std::format("{} uncompressed bytes x {} iterations (times include a re-serialization check)", expected.size(),
+                             iterations)
+              << std::endl;
+    std::cout << std::format("whole buffer: {:.3f} ms, {} bytes of transient buffers", whole / iterations, peakBuffers)
+              << std::endl;
+    std::cout << std::format("streaming:    {:.3f} ms, {} bytes of transient buffers", streaming / iterations,
+                             64 * 1024 + 128 * 1024)
+              << std::endl;
+    std::cout << std::format("async:        {:.3f} ms, {} bytes of transient buffers", async / iterations,
+                             64 * 1024 + 2 * 128 * 1024 + 2 * 64 * 1024)
+              << std::endl;
+
+    std::remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include "corpus.hpp"
+#include <iostream>
+
+using namespace nbt;
+
+// counts what the trees allocate
+class CountingResource : public std::pmr::memory_resource {
+  public:
+    size_t bytes = 0;
+    size_t allocations = 0;
+
+  private:
+    void* do_allocate(size_t size, size_t align) override {
+        bytes += size;
+        allocations++;
+        return std::pmr::new_delete_resource()->allocate(size, align);
+    }
+    void do_deallocate(void* ptr, size_t size, size_t align) override {
+        std::pmr::new_delete_resource()->deallocate(ptr, size, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+struct KeyCounter : BaseVisitor {
+    size_t keys = 0;
+    size_t keyBytes = 0;
+    Visit key(std::string_view name, TagID tag) {
+        keys++;
+        keyBytes += name.size();
+        return Visit::Continue;
+    }
+};
+
+// Reports what loading the chunk corpus allocates now that compound keys are interned.
+int main(int argc, char** argv) {
+    auto chunks = argc > 1 ? std::stoi(argv[1]) : 128;
+
+    std::vector<std::vector<uint8_t>> corpus;
+    KeyCounter counter;
+    for (int i = 0; i < chunks; i++) {
+        corpus.push_back(corpus::chunk(i + 1));
+        parseEvents(corpus.back(), counter);
+    }
+
+    // trees outside a Document intern into the shared table
+    CountingResource mem;
+    std::vector<CompoundValue*> trees;
+    auto parseTime = corpus::timeMs([&] {
+        for (auto& bytes : corpus) {
+            auto root = makeValue<CompoundValue>(&mem);
+            auto r = StreamReader(bytes);
+            r.skip(3);
+            root->deserialize(r, TagID::Compound);
+            trees.push_back(root);
+        }
+    });
+
+    // a document interns into its own table which is freed together with it
+    Document doc;
+    size_t docKeys = 0, docKeyBytes = 0;
+    for (auto& bytes : corpus) {
+        loadFromBytes(bytes, doc);
+        docKeys = std::max(docKeys, doc.keys().size());
+        docKeyBytes = std::max(docKeyBytes, doc.keys().bytes());
+    }
+
+    auto& shared = KeyTable::shared();
+    std::cout << std::format("{} chunks, {} keys read ({} KB of characters)", chunks, counter.keys, counter.keyBytes / 1024)
+              << std::endl;
+    std::cout << std::format("heap trees: parse {:.2f} ms, {} KB in {} allocations", parseTime, mem.bytes / 1024, mem.allocations)
+              << std::endl;
+    std::cout << std::format("shared table: {} keys beyond the built-in ones, {} bytes", shared.size(), shared.bytes())
+              << std::endl;
+    std::cout << std::format("document table: at most {} keys beyond the built-in ones, {} bytes", docKeys, docKeyBytes)
+              << std::endl;
+    std::cout << std::format("compound entries take {} bytes (key handle + value)", sizeof(CompoundMap::value_type)) << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include "corpus.hpp"
+#include <iostream>
+
+using namespace nbt;
+
+// counts what a tree allocates
+class CountingResource : public std::pmr::memory_resource {
+  public:
+    size_t bytes = 0;
+    size_t allocations = 0;
+
+  private:
+    void* do_allocate(size_t size, size_t align) override {
+        bytes += size;
+        allocations++;
+        return std::pmr::new_delete_resource()->allocate(size, align);
+    }
+    void do_deallocate(void* ptr, size_t size, size_t align) override {
+        std::pmr::new_delete_resource()->deallocate(ptr, size, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+// Loads a file holding large numeric lists and compares the unboxed storage against boxed SimpleValues.
+int main(int argc, char** argv) {
+    auto count = argc > 1 ? std::stoi(argv[1]) : 100000;
+
+    CompoundValue root;
+    auto doubles = new ListValue(TagID::Double);
+    auto ints = new ListValue(TagID::Int);
+    auto& d = doubles->getNumbers<double>();
+    auto& n = ints->getNumbers<int>();
+    for (int i = 0; i < count; i++) {
+        d.push_back(i * 0.25);
+        n.push_back(i * 7);
+    }
+    root.getItems()["Motion"] = doubles;
+    root.getItems()["Ids"] = ints;
+    auto bytes = saveToBytes(&root);
+
+    CountingResource unboxedMem;
+    auto unboxed = makeValue<CompoundValue>(&unboxedMem);
+    auto parseTime = corpus::timeMs([&] {
+        auto r = StreamReader(bytes);
+        r.skip(3);
+        unboxed->deserialize(r, TagID::Compound);
+    });
+
+    double unboxedSum = 0;
+    auto unboxedScan = corpus::timeMs([&] {
+        for (auto x : unboxed->getItems()["Motion"]->asList()->getNumbers<double>())
+            unboxedSum += x;
+    });
+
+    // boxing every item is what the list used to hold
+    CountingResource boxedMem;
+    auto boxed = makeValue<CompoundValue>(&boxedMem);
+    auto boxedParse = corpus::timeMs([&] {
+        auto r = StreamReader(bytes);
+        r.skip(3);
+        boxed->deserialize(r, TagID::Compound);
+        boxed->getItems()["Motion"]->asList()->getItems();
+        boxed->getItems()["Ids"]->asList()->getItems();
+    });
+
+    double boxedSum = 0;
+    auto boxedScan = corpus::timeMs([&] {
+        for (auto val : boxed->getItems()["Motion"]->asList()->getItems())
+            boxedSum += std::get<double>(val->asSimple()->get());
+    });
+
+    if (unboxedSum != boxedSum || saveToBytes(unboxed) != bytes || saveToBytes(boxed) != bytes) {
+        std::cerr << "Boxed and unboxed lists disagree" << std::endl;
+        return 1;
+    }
+
+    std::cout << std::format("2 lists of {} items, {} KB serialized", count, bytes.size() / 1024) << std::endl;
+    std::cout << std::format("unboxed: parse {:.2f} ms, scan {:.3f} ms, {} KB in {} allocations", parseTime, unboxedScan,
+                             unboxedMem.bytes / 1024, unboxedMem.allocations)
+              << std::endl;
+    std::cout << std::format("boxed:   parse {:.2f} ms, scan {:.3f} ms, {} KB in {} allocations", boxedParse, boxedScan,
+                             boxedMem.bytes / 1024, boxedMem.allocations)
+              << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,170 @@
+#include "corpus.hpp"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <filesystem>
+#include <new>
+#include <cstdlib>
+
+using namespace nbt;
+
+// Throughput and allocation benchmarks of the public load/save API over the deterministic corpora.
+// Every benchmark reports bytes_per_second (of uncompressed NBT) and the heap allocations per iteration, run with
+// --benchmark_format=json (or --benchmark_out=<file> --benchmark_out_format=json) for machine-readable results.
+
+static std::atomic<size_t> g_allocs = 0;
+static std::atomic<size_t> g_allocBytes = 0;
+
+void* operator new(size_t size) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    g_allocBytes.fetch_add(size, std::memory_order_relaxed);
+    if (auto p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t align) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    g_allocBytes.fetch_add(size, std::memory_order_relaxed);
+    auto al = static_cast<size_t>(align);
+    if (auto p = std::aligned_alloc(al, (std::max<size_t>(size, 1) + al - 1) / al * al))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+    struct Corpus {
+        const char* name;
+        std::vector<uint8_t> bytes;
+    };
+
+    // counts the allocations made by the timed loop and reports them per iteration
+    class AllocCounter {
+      public:
+        AllocCounter() : m_allocs(g_allocs.load()), m_bytes(g_allocBytes.load()) {}
+
+        void report(benchmark::State& state, size_t bytesPerIteration) {
+            auto iterations = (double)state.iterations();
+            state.counters["allocs"] = (double)(g_allocs.load() - m_allocs) / iterations;
+            state.counters["alloc_bytes"] = (double)(g_allocBytes.load() - m_bytes) / iterations;
+            state.SetBytesProcessed((int64_t)(state.iterations() * bytesPerIteration));
+        }
+
+      private:
+        size_t m_allocs;
+        size_t m_bytes;
+    };
+
+    std::string tempPath(const Corpus& corpus) {
+        return (std::filesystem::temp_directory_path() / std::format("nbtpp_bench_{}.nbt", corpus.name)).string();
+    }
+
+    // loads include freeing the tree, that is part of what an arena saves
+    void loadBytes(benchmark::State& state, const Corpus* corpus) {
+        auto bytes = corpus->bytes;
+        AllocCounter counter;
+        for (auto _ : state) {
+            auto root = loadFromBytes(bytes);
+            benchmark::DoNotOptimize(root);
+        }
+        counter.report(state, bytes.size());
+    }
+
+    void loadBytesDocument(benchmark::State& state, const Corpus* corpus) {
+        auto bytes = corpus->bytes;
+        Document doc;
+        AllocCounter counter;
+        for (auto _ : state) {
+            auto& root = loadFromBytes(bytes, doc);
+            benchmark::DoNotOptimize(&root);
+        }
+        counter.report(state, bytes.size());
+    }
+
+    void saveBytes(benchmark::State& state, const Corpus* corpus) {
+        auto bytes = corpus->bytes;
+        auto root = loadFromBytes(bytes);
+        AllocCounter counter;
+        for (auto _ : state) {
+            auto out = saveToBytes(&root);
+            benchmark::DoNotOptimize(out.data());
+        }
+        counter.report(state, bytes.size());
+    }
+
+#ifdef nbtpp_zlib
+    void loadCompressed(benchmark::State& state, const Corpus* corpus) {
+        auto bytes = corpus->bytes;
+        auto path = tempPath(*corpus);
+        auto root = loadFromBytes(bytes);
+        saveToCompressedFile(path, &root);
+
+        AllocCounter counter;
+        for (auto _ : state) {
+            auto loaded = loadFromCompressedFile(path);
+            benchmark::DoNotOptimize(loaded);
+        }
+        counter.report(state, bytes.size());
+        state.counters["compressed_bytes"] = (double)std::filesystem::file_size(path);
+        std::filesystem::remove(path);
+    }
+
+    void saveCompressed(benchmark::State& state, const Corpus* corpus) {
+        auto bytes = corpus->bytes;
+        auto path = tempPath(*corpus);
+        auto root = loadFromBytes(bytes);
+
+        AllocCounter counter;
+        for (auto _ : state)
+            saveToCompressedFile(path, &root);
+        counter.report(state, bytes.size());
+        state.counters["compressed_bytes"] = (double)std::filesystem::file_size(path);
+        std::filesystem::remove(path);
+    }
+#endif
+} // namespace
+
+int main(int argc, char** argv) {
+    // generated once up front, the benchmarks only read them
+    static const std::vector<Corpus> corpora = [] {
+        std::vector<Corpus> c;
+        c.push_back({"chunk", corpus::chunk()});
+        c.push_back({"player", corpus::player()});
+        c.push_back({"longArrays", corpus::longArrays()});
+        c.push_back({"deep", corpus::deep()});
+        c.push_back({"wide", corpus::wide()});
+        return c;
+    }();
+
+    for (const auto& c : corpora) {
+        benchmark::RegisterBenchmark(std::format("loadFromBytes/{}", c.name).c_str(), loadBytes, &c);
+        benchmark::RegisterBenchmark(std::format("loadFromBytes/doc/{}", c.name).c_str(), loadBytesDocument, &c);
+        benchmark::RegisterBenchmark(std::format("saveToBytes/{}", c.name).c_str(), saveBytes, &c);
+#ifdef nbtpp_zlib
+        benchmark::RegisterBenchmark(std::format("loadFromCompressedFile/{}", c.name).c_str(), loadCompressed, &c);
+        benchmark::RegisterBenchmark(std::format("saveToCompressedFile/{}", c.name).c_str(), saveCompressed, &c);
+#endif
+    }
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include "corpus.hpp"
+#include <iostream>
+
+using namespace nbt;
+
+// Serial against parallel serialization of large trees, from 2 threads to every core and over a few grain sizes.
+int main(int argc, char** argv) {
+    auto iterations = argc > 1 ? std::stoi(argv[1]) : 20;
+
+    // a region's worth of chunks in one tree, and a structure-like file with one large list of small compounds
+    CompoundValue region;
+    auto chunks = new ListValue(TagID::Compound);
+    for (int i = 0; i < 256; i++) {
+        auto bytes = corpus::chunk(i + 1);
+        chunks->appendValues({new CompoundValue(loadFromBytes(bytes))});
+    }
+    region.getItems()["Chunks"] = chunks;
+
+    CompoundValue structure;
+    auto blocks = new ListValue(TagID::Compound);
+    for (int i = 0; i < 200000; i++) {
+        auto block = new CompoundValue();
+        block->getItems()["pos"] = new ListValue(TagID::Int, {new SimpleValue(i % 64), new SimpleValue(i / 4096), new SimpleValue(i / 64 % 64)});
+        block->getItems()["state"] = new SimpleValue(i % 37);
+        blocks->appendValues({block});
+    }
+    structure.getItems()["blocks"] = blocks;
+
+    auto cores = std::max(2u, std::thread::hardware_concurrency());
+    for (auto [name, tree] : {std::pair {"region", &region}, {"structure", &structure}}) {
+        auto mb = savedSize(tree) / 1048576.0 * iterations;
+        auto serial = corpus::timeMs([&] {
+            for (int i = 0; i < iterations; i++)
+                auto out = saveToBytes(tree);
+        });
+        std::cout << std::format("{} ({:.1f} MB): serial {:.1f} MB/s", name, mb / iterations, mb / serial * 1000) << std::endl;
+
+        for (size_t threads = 2;; threads = std::min<size_t>(threads * 2, cores)) {
+            // the calling thread works too
+            ThreadPool pool(threads - 1);
+            for (size_t grain : {64 * 1024, 256 * 1024, 1024 * 1024}) {
+                auto parallel = corpus::timeMs([&] {
+                    for (int i = 0; i < iterations; i++)
+                        auto out = saveToBytesParallel(tree, Encoding::Java, pool, grain);
+                });
+                std::cout << std::format("  {:>3} threads, grain {:>5} KiB: {:>8.1f} MB/s ({:.2f}x)", threads, grain / 1024,
+                                         mb / parallel * 1000, serial / parallel)
+                          << std::endl;
+            }
+            if (threads == cores)
+                break;
+        }
+    }
+    return 0;
+}
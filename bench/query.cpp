@@ -0,0 +1,57 @@
+#include "corpus.hpp"
+#include <iostream>
+
+using namespace nbt;
+
+// Extracts Level.Sections[*].BlockStates from many chunks: full load and navigation against a compiled PathQuery.
+int main(int argc, char** argv) {
+    auto chunks = argc > 1 ? std::stoi(argv[1]) : 256;
+
+    std::vector<std::vector<uint8_t>> corpus;
+    size_t totalBytes = 0;
+    for (int i = 0; i < chunks; i++) {
+        corpus.push_back(corpus::chunk(i + 1));
+        totalBytes += corpus.back().size();
+    }
+
+    size_t loadedStates = 0;
+    auto loadTime = corpus::timeMs([&] {
+        for (auto& bytes : corpus) {
+            auto root = loadFromBytes(bytes);
+            auto level = root.getItems()["Level"]->asCompound();
+            for (auto section : level->getItems()["Sections"]->asList()->getItems()) {
+                loadedStates += section->asCompound()->getItems()["BlockStates"]->asArray<long long>()->getItems().size();
+            }
+        }
+    });
+
+    auto query = PathQuery("Level.Sections[*].BlockStates");
+    size_t queriedStates = 0;
+    auto queryTime = corpus::timeMs([&] {
+        for (auto& bytes : corpus) {
+            for (auto& value : query.select(bytes))
+                queriedStates += value->asArray<long long>()->getItems().size();
+        }
+    });
+
+    size_t viewedStates = 0;
+    auto viewTime = corpus::timeMs([&] {
+        for (auto& bytes : corpus) {
+            for (auto& view : query.view(bytes))
+                viewedStates += view.asLongArray().length();
+        }
+    });
+
+    if (loadedStates != queriedStates || loadedStates != viewedStates) {
+        std::cerr << std::format("Mismatch: {} / {} / {} block states", loadedStates, queriedStates, viewedStates) << std::endl;
+        return 1;
+    }
+
+    auto mb = totalBytes / 1048576.0;
+    std::cout << std::format("{} chunks, {:.1f} MB, {} block states", chunks, mb, loadedStates) << std::endl;
+    std::cout << std::format("load + navigate: {:8.2f} ms ({:.0f} MB/s)", loadTime, mb / loadTime * 1000) << std::endl;
+    std::cout << std::format("query select:    {:8.2f} ms ({:.0f} MB/s)", queryTime, mb / queryTime * 1000) << std::endl;
+    std::cout << std::format("query view:      {:8.2f} ms ({:.0f} MB/s)", viewTime, mb / viewTime * 1000) << std::endl;
+
+    return 0;
+}
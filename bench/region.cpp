@@ -0,0 +1,36 @@
+#include "corpus.hpp"
+#include <RegionFile.hpp>
+#include <iostream>
+
+using namespace nbt;
+
+// Decodes every chunk of a synthetic region file with 1..N threads to show how it scales with the core count.
+int main(int argc, char** argv) {
+    auto path = std::string("bench_region.mca");
+    corpus::region(path);
+    auto region = RegionFile(path);
+
+    auto maxThreads = argc > 1 ? std::stoul(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    double single = 0;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        // the calling thread takes part too, so the pool gets one thread less
+        auto pool = ThreadPool(threads > 1 ? threads - 1 : 1);
+        std::vector<std::unique_ptr<CompoundValue>> chunks;
+        auto ms = corpus::timeMs([&] {
+            if (threads == 1) {
+                chunks.resize(RegionFile::ChunkCount);
+                for (size_t i = 0; i < RegionFile::ChunkCount; i++)
+                    chunks[i] = std::make_unique<CompoundValue>(region.readChunk(i));
+            } else {
+                chunks = region.readAllChunks(pool);
+            }
+        });
+        if (threads == 1)
+            single = ms;
+
+        std::cout << std::format("{} threads: {:.2f} ms ({:.2f}x)", threads, ms, single / ms) << std::endl;
+    }
+
+    std::remove(path.c_str());
+    return 0;
+}
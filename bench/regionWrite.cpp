@@ -0,0 +1,41 @@
+#include "corpus.hpp"
+#include <RegionWriter.hpp>
+#include <iostream>
+
+using namespace nbt;
+
+// Writes a full region file with 1..N pool threads compressing the chunks (the calling thread helps too), then
+// times an in-place update of a few chunks.
+int main(int argc, char** argv) {
+    auto path = std::string("bench_region_write.mca");
+    std::vector<CompoundValue> chunks;
+    chunks.reserve(RegionFile::ChunkCount);
+    for (size_t i = 0; i < RegionFile::ChunkCount; i++) {
+        auto bytes = corpus::chunk(i + 1);
+        chunks.push_back(loadFromBytes(bytes));
+    }
+
+    auto maxThreads = argc > 1 ? std::stoul(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    double single = 0;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        auto pool = ThreadPool(threads);
+        auto writer = RegionWriter(pool);
+        auto ms = corpus::timeMs([&] {
+            for (size_t i = 0; i < RegionFile::ChunkCount; i++)
+                writer.setChunk(i, &chunks[i]);
+            writer.write(path);
+        });
+        if (threads == 1)
+            single = ms;
+        std::cout << std::format("full write, {} pool threads: {:.2f} ms ({:.2f}x)", threads, ms, single / ms) << std::endl;
+    }
+
+    auto writer = RegionWriter();
+    for (auto index : {3, 100, 900})
+        writer.setChunk(index, &chunks[index]);
+    auto ms = corpus::timeMs([&] { writer.update(path); });
+    std::cout << std::format("in-place update of 3 chunks: {:.2f} ms", ms) << std::endl;
+
+    std::remove(path.c_str());
+    return 0;
+}
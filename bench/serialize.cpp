@@ -0,0 +1,47 @@
+#include "corpus.hpp"
+#include <iostream>
+
+using namespace nbt;
+
+// Serialize throughput of a chunk tree into a growing buffer, an exactly presized buffer and a caller-provided one,
+// with a plain memcpy of the same amount of bytes as the upper bound.
+int main(int argc, char** argv) {
+    auto iterations = argc > 1 ? std::stoi(argv[1]) : 500;
+    auto bytes = corpus::chunk();
+    auto tree = loadFromBytes(bytes);
+    auto size = savedSize(&tree);
+    auto mb = double(size) * iterations / (1024 * 1024);
+
+    auto growing = corpus::timeMs([&] {
+        for (int i = 0; i < iterations; i++) {
+            auto w = StreamWriter();
+            w.writeRaw({0x0A, 0x00, 0x00});
+            tree.serialize(w);
+            auto out = w.takeBytes();
+        }
+    });
+    auto presized = corpus::timeMs([&] {
+        for (int i = 0; i < iterations; i++)
+            auto out = saveToBytes(&tree);
+    });
+    std::vector<uint8_t> buffer(size);
+    auto provided = corpus::timeMs([&] {
+        for (int i = 0; i < iterations; i++)
+            saveToBytes(&tree, buffer);
+    });
+    std::vector<uint8_t> copy(size);
+    volatile uint8_t sink = 0;
+    auto memcpyMs = corpus::timeMs([&] {
+        for (int i = 0; i < iterations; i++) {
+            memcpy(copy.data(), bytes.data(), size);
+            sink = copy[i % size];
+        }
+    });
+
+    std::cout << std::format("{} bytes x {} iterations", size, iterations) << std::endl;
+    std::cout << std::format("growing buffer:  {:.1f} MB/s", mb / growing * 1000) << std::endl;
+    std::cout << std::format("presized buffer: {:.1f} MB/s", mb / presized * 1000) << std::endl;
+    std::cout << std::format("caller buffer:   {:.1f} MB/s", mb / provided * 1000) << std::endl;
+    std::cout << std::format("memcpy:          {:.1f} MB/s", mb / memcpyMs * 1000) << std::endl;
+    return 0;
+}
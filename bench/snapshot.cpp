@@ -0,0 +1,57 @@
+#include "corpus.hpp"
+#include <iostream>
+#include <thread>
+#include <optional>
+
+using namespace nbt;
+
+// Snapshots of a world-sized tree against a deep copy, and the cost of editing a tree which shares its nodes.
+int main(int argc, char** argv) {
+    auto chunks = argc > 1 ? std::stoi(argv[1]) : 1024;
+
+    CompoundValue world;
+    for (int i = 0; i < chunks; i++) {
+        auto bytes = corpus::chunk(i + 1);
+        world.getItems()[std::format("chunk.{}", i)] = new CompoundValue(loadFromBytes(bytes));
+    }
+    auto before = saveToBytes(&world);
+    std::cout << std::format("{} chunks, {:.1f} MB", chunks, before.size() / 1048576.0) << std::endl;
+
+    std::vector<uint8_t> copyBytes;
+    auto copyTime = corpus::timeMs([&] {
+        copyBytes = saveToBytes(&world);
+        auto copy = loadFromBytes(copyBytes, Trust::Trusted);
+    });
+    std::optional<CompoundValue> snapshot;
+    auto snapshotTime = corpus::timeMs([&] { snapshot.emplace(world.snapshot()); });
+    std::cout << std::format("deep copy {:.3f} ms, snapshot {:.3f} ms", copyTime, snapshotTime) << std::endl;
+
+    // the first edit of a chunk copies the root's entry, the chunk and Level; later ones copy nothing
+    auto edit = [&](int round) {
+        for (int i = 0; i < chunks; i++) {
+            auto level = world.edit(std::format("chunk.{}", i))->asCompound()->edit("Level")->asCompound();
+            level->edit("xPos")->asSimple()->set(round * chunks + i);
+        }
+    };
+    auto firstEdit = corpus::timeMs([&] { edit(1); });
+    auto secondEdit = corpus::timeMs([&] { edit(2); });
+    std::cout << std::format("editing every chunk: shared {:.3f} ms, private {:.3f} ms", firstEdit, secondEdit) << std::endl;
+
+    if (saveToBytes(&*snapshot) != before)
+        std::cout << "the snapshot changed!" << std::endl;
+
+    // a saver thread writing the snapshot while the tree keeps being edited
+    snapshot.emplace(world.snapshot());
+    auto expected = saveToBytes(&*snapshot);
+    std::vector<uint8_t> saved;
+    auto concurrentTime = corpus::timeMs([&] {
+        std::thread saver([&] { saved = saveToBytes(&*snapshot); });
+        for (int round = 3; round < 8; round++)
+            edit(round);
+        saver.join();
+    });
+    std::cout << std::format("saving a snapshot during 5 rounds of edits: {:.3f} ms, {}", concurrentTime,
+                             saved == expected ? "consistent" : "INCONSISTENT")
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include "corpus.hpp"
+#include <iostream>
+
+using namespace nbt;
+
+// SNBT printing and parsing throughput, in MB of text per second. "events" prints straight from the binary data
+// through parseEvents without building a tree.
+int main(int argc, char** argv) {
+    auto iterations = argc > 1 ? std::stoi(argv[1]) : 50;
+
+    std::pair<const char*, std::vector<uint8_t>> corpora[] = {
+        {"chunk", corpus::chunk()},
+        {"player", corpus::player()},
+        {"longArrays", corpus::longArrays(1 << 16)},
+    };
+
+    Document doc;
+    for (auto& [name, bytes] : corpora) {
+        auto tree = loadFromBytes(bytes);
+        std::cout << std::format("{}:", name) << std::endl;
+        for (auto [style, label] : {std::pair {SnbtStyle::Compact, "compact"}, {SnbtStyle::Pretty, "pretty"}}) {
+            auto text = saveToSnbt(&tree, style);
+            auto mb = text.size() / 1048576.0 * iterations;
+
+            std::string out;
+            auto print = corpus::timeMs([&] {
+                for (int i = 0; i < iterations; i++) {
+                    out.clear();
+                    writeSnbt(out, &tree, style);
+                }
+            });
+            auto events = corpus::timeMs([&] {
+                for (int i = 0; i < iterations; i++) {
+                    out.clear();
+                    auto writer = SnbtWriter(out, style);
+                    parseEvents(bytes, writer);
+                }
+            });
+            auto parse = corpus::timeMs([&] {
+                for (int i = 0; i < iterations; i++)
+                    loadFromSnbt(text, doc);
+            });
+
+            std::cout << std::format("  {:<8} {:>9} chars  print {:>7.1f} MB/s  events {:>7.1f} MB/s  parse {:>7.1f} MB/s", label,
+                                     text.size(), mb / print * 1000, mb / events * 1000, mb / parse * 1000)
+                      << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,192 @@
+#include "corpus.hpp"
+#include <iostream>
+#include <limits>
+
+using namespace nbt;
+
+// Checks that SNBT reproduces binary NBT exactly: every tree goes binary -> SNBT -> binary in both styles, and the
+// SNBT printed from the bytes through parseEvents has to match the one printed from the tree. The trees are the
+// benchmark corpora and random ones mixing the cases text gets wrong most easily: escapes and keys which need
+// quoting, empty and nested lists, the limits of every integer type, -0, NaN and the infinities.
+// Empty lists are written with the End tag and NaN is the quiet one, that is what SNBT can express.
+namespace {
+    struct RandomTree {
+        std::mt19937_64 rng;
+
+        size_t pick(size_t count) { return rng() % count; }
+
+        std::string string() {
+            static constexpr std::string_view parts[] = {"", "a", "minecraft:stone", " ", "\"", "'", "\\", "\\\"", "\n",
+                                                         "\t", "{", "}", "[", "]", ",", ":", ";", "é", "☃", "1b", "-0",
+                                                         "true", "NaN", "0x10", "1e5"};
+            std::string out;
+            for (size_t i = pick(4); i > 0; i--)
+                out += parts[pick(std::size(parts))];
+            return out;
+        }
+
+        template <typename T>
+        T integer() {
+            switch (pick(4)) {
+            case 0:
+                return std::numeric_limits<T>::min();
+            case 1:
+                return std::numeric_limits<T>::max();
+            case 2:
+                return T(pick(3)) - 1;
+            default:
+                return static_cast<T>(rng());
+            }
+        }
+
+        template <typename T>
+        T floating() {
+            switch (pick(8)) {
+            case 0:
+                return T(-0.0);
+            case 1:
+                return std::numeric_limits<T>::quiet_NaN();
+            case 2:
+                return pick(2) ? std::numeric_limits<T>::infinity() : -std::numeric_limits<T>::infinity();
+            case 3:
+                return pick(2) ? std::numeric_limits<T>::max() : std::numeric_limits<T>::lowest();
+            case 4:
+                return pick(2) ? std::numeric_limits<T>::denorm_min() : std::numeric_limits<T>::min();
+            default: {
+                // any bits which are not a NaN
+                using U = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+                auto val = std::bit_cast<T>(static_cast<U>(rng()));
+                return std::isnan(val) ? T(1.5) : val;
+            }
+            }
+        }
+
+        template <typename T>
+        ArrayValue<T>* array() {
+            auto arr = new ArrayValue<T>();
+            arr->getItems().resize(pick(3) ? pick(8) : 0);
+            for (auto& x : arr->getItems())
+                x = integer<T>();
+            return arr;
+        }
+
+        Value* scalar(TagID id) {
+            switch (id) {
+            case TagID::Byte:
+                return new SimpleValue(integer<char>());
+            case TagID::Short:
+                return new SimpleValue(integer<short>());
+            case TagID::Int:
+                return new SimpleValue(integer<int>());
+            case TagID::Long:
+                return new SimpleValue(integer<long long>());
+            case TagID::Float:
+                return new SimpleValue(floating<float>());
+            case TagID::Double:
+                return new SimpleValue(floating<double>());
+            default:
+                return new SimpleValue(string());
+            }
+        }
+
+        Value* value(TagID id, int depth) {
+            switch (id) {
+            case TagID::ByteArray:
+                return array<char>();
+            case TagID::IntArray:
+                return array<int>();
+            case TagID::LongArray:
+                return array<long long>();
+            case TagID::List:
+                return list(depth + 1);
+            case TagID::Compound:
+                return compound(depth + 1);
+            default:
+                return scalar(id);
+            }
+        }
+
+        TagID tag(int depth) {
+            // containers get rarer further down, so the trees stay small
+            auto id = static_cast<TagID>(1 + pick(12));
+            if ((id == TagID::List || id == TagID::Compound) && pick(6) < size_t(depth))
+                return TagID::String;
+            return id;
+        }
+
+        Value* list(int depth) {
+            auto len = pick(3) ? pick(6) : 0;
+            if (!len)
+                return new ListValue(TagID::End);
+            auto id = tag(depth);
+            auto list = new ListValue(id);
+            for (size_t i = 0; i < len; i++)
+                list->appendValues({value(id, depth)});
+            return list;
+        }
+
+        CompoundValue* compound(int depth) {
+            auto compound = new CompoundValue();
+            for (size_t i = pick(7); i > 0; i--) {
+                auto val = value(tag(depth), depth);
+                if (!compound->getItems().emplace(string(), val).second)
+                    Value::release(val);
+            }
+            return compound;
+        }
+    };
+
+    // what the SNBT of `bytes` reads back as, nothing if it matches
+    std::optional<std::string> roundTrip(std::vector<uint8_t>& bytes) {
+        auto tree = loadFromBytes(bytes);
+        for (auto style : {SnbtStyle::Compact, SnbtStyle::Pretty}) {
+            auto text = saveToSnbt(&tree, style);
+            std::string events;
+            auto writer = SnbtWriter(events, style);
+            parseEvents(bytes, writer);
+            if (events != text)
+                return std::format("events printed:\n{}\ninstead of:\n{}", events, text);
+
+            std::optional<CompoundValue> parsed;
+            try {
+                parsed.emplace(loadFromSnbt(text));
+            } catch (const std::exception& e) {
+                return std::format("failed to read back ({}):\n{}", e.what(), text);
+            }
+            if (saveToBytes(&*parsed) != bytes)
+                return std::format("read back differently:\n{}\nas:\n{}", text, saveToSnbt(&*parsed, style));
+        }
+        return std::nullopt;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    auto trees = argc > 1 ? std::stoi(argv[1]) : 10000;
+
+    std::pair<const char*, std::vector<uint8_t>> corpora[] = {
+        {"chunk", corpus::chunk()},
+        {"player", corpus::player()},
+        {"longArrays", corpus::longArrays(1 << 12)},
+        {"deep", corpus::deep()},
+        {"wide", corpus::wide(10000)},
+    };
+    for (auto& [name, bytes] : corpora) {
+        if (auto error = roundTrip(bytes)) {
+            std::cout << std::format("{}: {}", name, *error) << std::endl;
+            return 1;
+        }
+    }
+
+    for (int seed = 0; seed < trees; seed++) {
+        auto random = RandomTree {std::mt19937_64(seed)};
+        auto root = std::unique_ptr<CompoundValue>(random.compound(0));
+        auto bytes = saveToBytes(root.get());
+        if (auto error = roundTrip(bytes)) {
+            std::cout << std::format("random tree {}: {}", seed, *error) << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << std::format("{} corpora and {} random trees read back identically", std::size(corpora), trees) << std::endl;
+    return 0;
+}
@@ -0,0 +1,42 @@
+#include "corpus.hpp"
+#include <iostream>
+
+using namespace nbt;
+
+// Decoding with every read checked against validating once and decoding without checks (untrusted input), and
+// against skipping the validation (trusted input). All of them decode into the same reused document.
+int main(int argc, char** argv) {
+    auto iterations = argc > 1 ? std::stoi(argv[1]) : 500;
+
+    std::pair<const char*, std::vector<uint8_t>> corpora[] = {
+        {"chunk", corpus::chunk()},
+        {"player", corpus::player()},
+        {"deep", corpus::deep()},
+    };
+
+    Document doc;
+    for (auto& [name, bytes] : corpora) {
+        double checked = 0, validation = 0, untrusted = 0, trusted = 0;
+        for (int i = 0; i < iterations; i++) {
+            checked += corpus::timeMs([&] {
+                doc.reset();
+                auto r = StreamReader(bytes);
+                readRoot(r, doc.root());
+            });
+            validation += corpus::timeMs([&] {
+                if (!validate(bytes))
+                    std::abort();
+            });
+            untrusted += corpus::timeMs([&] { loadFromBytes(bytes, doc); });
+            trusted += corpus::timeMs([&] { loadFromBytes(bytes, doc, Trust::Trusted); });
+        }
+
+        std::cout << std::format("{} ({} bytes):", name, bytes.size()) << std::endl;
+        std::cout << std::format("  checked reads:            {:.4f} ms", checked / iterations) << std::endl;
+        std::cout << std::format("  validation alone:         {:.4f} ms", validation / iterations) << std::endl;
+        std::cout << std::format("  validated + unchecked:    {:.4f} ms", untrusted / iterations) << std::endl;
+        std::cout << std::format("  trusted (unchecked only): {:.4f} ms", trusted / iterations) << std::endl;
+    }
+
+    return 0;
+}
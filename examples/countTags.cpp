@@ -0,0 +1,67 @@
+#include <nbtpp.hpp>
+#include <iostream>
+#include <map>
+
+using namespace nbt;
+
+// Counts tags in uncompressed NBT files without building a tree, the keys given after `--skip` are not descended into
+struct CountingVisitor : BaseVisitor {
+    std::map<std::string_view, size_t> counts;
+    std::vector<std::string_view> skipped;
+
+    Visit beginCompound() {
+        counts["Compound"]++;
+        return Visit::Continue;
+    }
+
+    Visit beginList(TagID itemsID, size_t length) {
+        counts["List"]++;
+        return Visit::Continue;
+    }
+
+    Visit key(std::string_view key, TagID id) {
+        if (std::find(skipped.begin(), skipped.end(), key) != skipped.end()) {
+            counts["Skipped"]++;
+            return Visit::Skip;
+        }
+        return Visit::Continue;
+    }
+
+    template <typename T>
+    void scalar(T value) {
+        counts["Scalar"]++;
+    }
+
+    void string(std::string_view value) { counts["String"]++; }
+
+    Visit beginArray(TagID id, size_t length) {
+        counts["Array"]++;
+        return Visit::Continue;
+    }
+};
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: countTags <file> [--skip key...]\n" << std::endl;
+        return 1;
+    }
+
+    CountingVisitor visitor;
+    for (auto i = 3; i < argc; i++) {
+        visitor.skipped.push_back(argv[i]);
+    }
+
+    try {
+        auto file = MappedFile(argv[1]);
+        parseEvents(file.bytes(), visitor);
+    } catch (const std::exception& e) {
+        std::cerr << std::format("Failed to parse {}: {}", argv[1], e.what()) << std::endl;
+        return 1;
+    }
+
+    for (const auto& [name, count] : visitor.counts) {
+        std::cout << std::format("{}: {}", name, count) << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include <nbtpp.hpp>
+#include <iostream>
+
+using namespace nbt;
+
+// Loads a file (compressed or not), saves it back compressed next to it and shows where the time went
+int main(int argc, char** argv) {
+    if constexpr (!StatsEnabled) {
+        std::cerr << "Compile nbtpp with NBTPP_STATS!" << std::endl;
+        return 1;
+    }
+    if (argc < 2) {
+        std::cerr << "Usage: loadStats <file>\n" << std::endl;
+        return 1;
+    }
+
+    constexpr const char* phases[] = {"read", "inflate", "parse", "serialize", "deflate", "write"};
+    constexpr const char* tags[] = {"End",    "Byte", "Short",    "Int",      "Long",     "Float",   "Double",
+                                    "ByteArray", "String", "List", "Compound", "IntArray", "LongArray"};
+
+    // what would be exported to a metrics system, one line per call
+    setStatsHook([&](std::string_view operation, const Stats& stats) {
+        std::cout << operation << ":";
+        for (size_t i = 0; i < PhaseCount; i++)
+            if (stats.phaseNanoseconds[i])
+                std::cout << std::format(" {} {:.3f} ms", phases[i], stats.phaseNanoseconds[i] / 1e6);
+        std::cout << std::endl;
+    });
+
+    auto path = std::string(argv[1]);
+    Stats stats;
+    try {
+        StatsScope scope(stats);
+        auto value = loadFromCompressedFile(path);
+        saveToCompressedFile(path + "_stats", &value);
+    } catch (const std::runtime_error& e) {
+        std::cerr << std::format("Failed to process file {}: {}", path, e.what()) << std::endl;
+        return 1;
+    }
+
+    std::cout << std::format("\n{:<10} {:>10} {:>12}", "tag", "count", "bytes") << std::endl;
+    for (size_t i = 1; i < TagCount; i++)
+        if (stats.tagCounts[i])
+            std::cout << std::format("{:<10} {:>10} {:>12}", tags[i], stats.tagCounts[i], stats.tagBytes[i]) << std::endl;
+    std::cout << std::format("\n{} allocations, {} bytes, max depth {}", stats.allocations, stats.allocatedBytes, stats.maxDepth)
+              << std::endl;
+    return 0;
+}
@@ -87,7 +87,7 @@ int main(int argc, char** argv) {
                 std::cout << std::format("* [{}] {}", name, x) << std::endl;
             } break;
             case TagID::String: {
-                auto x = std::get<std::string>(simpleValue->get());
+                auto x = std::get<std::pmr::string>(simpleValue->get());
                 std::cout << std::format("* [{}] {}", name, x) << std::endl;
             } break;
             case TagID::List: {
@@ -1,4 +1,5 @@
 #include <nbtpp.hpp>
+#include <Batch.hpp>
 #include <functional>
 #include <iostream>
 
@@ -10,18 +11,15 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    for (auto i = 1u; i < argc; i++) {
-        auto fileName = argv[i];
+    // the files are loaded and saved concurrently, each one on a thread of the shared pool
+    std::vector<std::string> paths(argv + 1, argv + argc);
+    auto results = loadFiles(paths, [&](size_t i, CompoundValue& value) { saveToFile(paths[i] + "_reexported", &value); });
 
-        try {
-            auto newName = std::string(fileName) + "_reexported";
-            std::cout << std::format("Re-exporting file {} to {}", fileName, newName) << std::endl;
-
-            auto value = loadFromFile(fileName);
-            saveToFile(newName, &value);
-        } catch (const std::runtime_error& e) {
-            std::cerr << std::format("Failed to process file {}: {}", fileName, e.what()) << std::endl;
-        }
+    for (auto& result : results) {
+        if (result.ok())
+            std::cout << std::format("Re-exported file {} to {}_reexported", result.path, result.path) << std::endl;
+        else
+            std::cerr << std::format("Failed to process file {}: {}", result.path, result.message()) << std::endl;
     }
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,35 @@
+#include <RegionFile.hpp>
+#include <iostream>
+
+using namespace nbt;
+
+// Decodes every chunk of the given region files in parallel and prints where each present chunk lives
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Please specify one or more region files!\n" << std::endl;
+        return 1;
+    }
+
+    for (auto i = 1; i < argc; i++) {
+        try {
+            auto region = RegionFile(argv[i]);
+            auto chunks = region.readAllChunks();
+
+            std::cout << std::format("Region {}", argv[i]) << std::endl;
+            for (size_t index = 0; index < RegionFile::ChunkCount; index++) {
+                if (!chunks[index])
+                    continue;
+
+                const auto& location = region.getLocation(index);
+                std::cout << std::format("  chunk {:>2} {:>2}: sector {}, {} sectors, {} root tags, timestamp {}", index % 32,
+                                         index / 32, location.offset, location.sectors, chunks[index]->getItems().size(),
+                                         region.getTimestamp(index))
+                          << std::endl;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << std::format("Failed to process region {}: {}", argv[i], e.what()) << std::endl;
+        }
+    }
+
+    return 0;
+}
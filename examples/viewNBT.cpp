@@ -0,0 +1,57 @@
+#include <nbtpp.hpp>
+#include <iostream>
+
+using namespace nbt;
+
+// Prints a single field of an uncompressed NBT file without building the tree, e.g. `viewNBT level.dat Data LevelName`
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: viewNBT <file> <key> [nested keys...]\n" << std::endl;
+        return 1;
+    }
+
+    try {
+        // the views point into the mapping, so it has to outlive them
+        auto file = MappedFile(argv[1]);
+        auto compound = viewFromBytes(file.bytes());
+        auto value = compound.at(argv[2]);
+        for (auto i = 3; i < argc; i++) {
+            value = value.asCompound().at(argv[i]);
+        }
+
+        switch (value.getID()) {
+        case TagID::Byte: {
+            std::cout << (int)value.as<char>() << std::endl;
+        } break;
+        case TagID::Short: {
+            std::cout << value.as<short>() << std::endl;
+        } break;
+        case TagID::Int: {
+            std::cout << value.as<int>() << std::endl;
+        } break;
+        case TagID::Long: {
+            std::cout << value.as<long long>() << std::endl;
+        } break;
+        case TagID::Float: {
+            std::cout << value.as<float>() << std::endl;
+        } break;
+        case TagID::Double: {
+            std::cout << value.as<double>() << std::endl;
+        } break;
+        case TagID::String: {
+            std::cout << value.asString() << std::endl;
+        } break;
+        case TagID::List: {
+            std::cout << std::format("List of {} items", value.asList().length()) << std::endl;
+        } break;
+        default: {
+            std::cout << std::format("Tag {} taking {} bytes", static_cast<int>(value.getID()), value.payloadSize()) << std::endl;
+        } break;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << std::format("Failed to read {}: {}", argv[1], e.what()) << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
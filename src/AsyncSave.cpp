@@ -0,0 +1,153 @@
+#include "AsyncSave.hpp"
+
+#include <format>
+#include <stdexcept>
+
+namespace nbt {
+    // the recycled buffer keeps its capacity, so saves of similar trees stop allocating after the first few
+    static void serializeInto(const Value* val, std::vector<uint8_t>& buffer, Encoding encoding) {
+        if (encoding == Encoding::Network) {
+            buffer = saveToBytes(val, encoding);
+            return;
+        }
+        buffer.resize(savedSize(val, encoding));
+        saveToBytes(val, buffer, encoding);
+    }
+
+    AsyncSaver::AsyncSaver(const AsyncSaveOptions& options, ThreadPool& pool) : m_options(options), m_pool(pool) {}
+
+    AsyncSaver::~AsyncSaver() {
+        flush();
+    }
+
+    std::future<void> AsyncSaver::save(const std::string& path, const CompoundValue& tree) {
+        // a full queue is reported before spending time on the tree
+        if (m_options.whenFull == Backpressure::Fail) {
+            std::lock_guard lock(m_mutex);
+            if (m_queued && m_queued >= m_options.maxQueued)
+                throw std::runtime_error(std::format("The save queue is full, \"{}\" was not saved", path));
+        }
+
+        auto stats = detail::CallStats("AsyncSaver::save");
+        auto job = std::make_shared<Job>();
+        job->path = path;
+        if (m_options.serializeOn == SerializeOn::Worker) {
+            job->snapshot.emplace(tree.snapshot());
+        } else {
+            job->bytes = takeBuffer();
+            serializeInto(&tree, job->bytes, m_options.encoding);
+            job->weight = job->bytes.size();
+        }
+        return enqueue(std::move(job));
+    }
+
+    std::future<void> AsyncSaver::save(const std::string& path, std::vector<uint8_t> bytes) {
+        auto job = std::make_shared<Job>();
+        job->path = path;
+        job->weight = bytes.size();
+        job->bytes = std::move(bytes);
+        return enqueue(std::move(job));
+    }
+
+    std::future<void> AsyncSaver::enqueue(std::shared_ptr<Job> job) {
+        auto future = job->done.get_future();
+        std::unique_lock lock(m_mutex);
+
+        auto hasRoom = [&] {
+            return m_queued == 0 || (m_queued < m_options.maxQueued && m_queuedBytes + job->weight <= m_options.maxQueuedBytes);
+        };
+        if (m_options.whenFull == Backpressure::Fail) {
+            if (!hasRoom()) {
+                lock.unlock();
+                recycle(std::move(job->bytes));
+                throw std::runtime_error(std::format("The save queue is full, \"{}\" was not saved", job->path));
+            }
+        } else {
+            m_cv.wait(lock, hasRoom);
+        }
+
+        m_queued++;
+        m_queuedBytes += job->weight;
+        m_waiting.push_back(std::move(job));
+        dispatch();
+        return future;
+    }
+
+    void AsyncSaver::dispatch() {
+        for (auto it = m_waiting.begin(); it != m_waiting.end();) {
+            if (!m_writing.insert((*it)->path).second) {
+                ++it;
+                continue;
+            }
+            m_pool.submit([this, job = std::move(*it)] { run(job); });
+            it = m_waiting.erase(it);
+        }
+    }
+
+    void AsyncSaver::run(const std::shared_ptr<Job>& job) {
+        std::vector<uint8_t> compressed;
+        // the stats end before the saver is told the save is done
+        auto stats = std::optional<detail::CallStats>("AsyncSaver::write");
+        try {
+            if (job->snapshot) {
+                job->bytes = takeBuffer();
+                serializeInto(&*job->snapshot, job->bytes, m_options.encoding);
+                job->snapshot.reset();
+            }
+
+            std::span<const uint8_t> out = job->bytes;
+            if (m_options.compression != Compression::None) {
+                auto timer = detail::PhaseTimer(Phase::Deflate);
+                auto& backend = backendFor(m_options.compression);
+                compressed = takeBuffer();
+                compressed.resize(backend.compressBound(job->bytes.size(), m_options.compression));
+                out = std::span(compressed).first(backend.compress(job->bytes, compressed, m_options.compression, m_options.level));
+            }
+
+            writeFileAtomically(job->path, out);
+            stats.reset();
+            job->done.set_value();
+        } catch (...) {
+            stats.reset();
+            job->done.set_exception(std::current_exception());
+        }
+        recycle(std::move(compressed));
+        recycle(std::move(job->bytes));
+
+        // notified with the lock held: once the count drops to 0 the destructor may return and free the saver
+        std::lock_guard lock(m_mutex);
+        m_writing.erase(job->path);
+        m_queued--;
+        m_queuedBytes -= job->weight;
+        dispatch();
+        m_cv.notify_all();
+    }
+
+    void AsyncSaver::flush() {
+        std::unique_lock lock(m_mutex);
+        m_cv.wait(lock, [&] { return m_queued == 0; });
+    }
+
+    size_t AsyncSaver::queued() {
+        std::lock_guard lock(m_mutex);
+        return m_queued;
+    }
+
+    std::vector<uint8_t> AsyncSaver::takeBuffer() {
+        std::lock_guard lock(m_mutex);
+        if (m_buffers.empty())
+            return {};
+        auto buffer = std::move(m_buffers.back());
+        m_buffers.pop_back();
+        return buffer;
+    }
+
+    void AsyncSaver::recycle(std::vector<uint8_t>&& buffer) {
+        if (!buffer.capacity())
+            return;
+        std::lock_guard lock(m_mutex);
+        // a serialization and a compression buffer per save in flight
+        if (m_buffers.size() < m_options.maxQueued * 2)
+            m_buffers.push_back(std::move(buffer));
+    }
+} // namespace nbt
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <condition_variable>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "nbtpp.hpp"
+#include "ThreadPool.hpp"
+
+namespace nbt {
+    // what AsyncSaver::save does when the queue is full
+    enum class Backpressure {
+        // waits for queued saves to finish
+        Block,
+        // throws std::runtime_error, the save is not queued
+        Fail
+    };
+
+    enum class SerializeOn {
+        // save() serializes the tree, which may be changed or destroyed as soon as it returns
+        Caller,
+        // save() takes a snapshot (see CompoundValue::snapshot, heap trees only) and a worker serializes it
+        Worker
+    };
+
+    struct AsyncSaveOptions {
+        // saves queued or being written at once
+        size_t maxQueued = 4;
+        // Serialized bytes held by the queued saves, a larger save still gets queued once the queue is empty.
+        // Snapshots are not serialized yet, so they only count against maxQueued.
+        size_t maxQueuedBytes = 64 * 1024 * 1024;
+        Backpressure whenFull = Backpressure::Block;
+        SerializeOn serializeOn = SerializeOn::Caller;
+        Encoding encoding = Encoding::Java;
+        // Compression::None writes plain NBT
+        Compression compression = Compression::Gzip;
+        int level = DefaultLevel;
+    };
+
+    // Saves files in the background: save() only serializes (or snapshots) the tree and queues it, compression and
+    // the crash-safe write (see writeFileAtomically) run on the pool. Saves of one path are written in the order
+    // they were queued, different paths in parallel. Serialization and compression buffers are recycled between
+    // saves, so the caller fills one while the workers compress and write the previous ones.
+    class AsyncSaver {
+      public:
+        AsyncSaver(const AsyncSaveOptions& options = {}, ThreadPool& pool = ThreadPool::shared());
+        AsyncSaver(const AsyncSaver&) = delete;
+        AsyncSaver& operator=(const AsyncSaver&) = delete;
+        // waits for every queued save
+        ~AsyncSaver();
+
+        // The future is ready once the file is on disk, get() rethrows what failed. With Backpressure::Block this
+        // waits while the queue is full, so a saver shared with the pool's own tasks must use Fail.
+        std::future<void> save(const std::string& path, const CompoundValue& tree);
+        // queues NBT which is already serialized (a whole file, see saveToBytes), it is still compressed
+        std::future<void> save(const std::string& path, std::vector<uint8_t> bytes);
+
+        // waits until everything queued so far is written (or failed)
+        void flush();
+        // saves queued or in progress
+        size_t queued();
+
+        inline const AsyncSaveOptions& options() const { return m_options; }
+
+      private:
+        struct Job {
+            std::string path;
+            std::vector<uint8_t> bytes;
+            std::optional<CompoundValue> snapshot;
+            size_t weight = 0; // bytes counted against maxQueuedBytes
+            std::promise<void> done;
+        };
+
+        std::future<void> enqueue(std::shared_ptr<Job> job);
+        // starts every waiting job whose path is not being written, with the lock held
+        void dispatch();
+        void run(const std::shared_ptr<Job>& job);
+
+        std::vector<uint8_t> takeBuffer();
+        void recycle(std::vector<uint8_t>&& buffer);
+
+        AsyncSaveOptions m_options;
+        ThreadPool& m_pool;
+
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::deque<std::shared_ptr<Job>> m_waiting;
+        std::unordered_set<std::string> m_writing;
+        size_t m_queued = 0;
+        size_t m_queuedBytes = 0;
+        std::vector<std::vector<uint8_t>> m_buffers;
+    };
+} // namespace nbt
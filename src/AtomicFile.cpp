@@ -0,0 +1,115 @@
+#include "AtomicFile.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <stdexcept>
+
+#include "Stats.hpp"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace nbt {
+    // unique per call and process, so concurrent saves of the same file don't write into each other's temporary
+    // file; it is still created exclusively, one left behind by a crashed process may have the same name
+    static std::string tempPathFor(const std::string& path) {
+        static std::atomic<uint64_t> counter = 0;
+#ifdef _WIN32
+        auto pid = GetCurrentProcessId();
+#else
+        auto pid = getpid();
+#endif
+        return std::format("{}.{}.{}.tmp", path, pid, counter++);
+    }
+
+#ifdef _WIN32
+    void writeFileAtomically(const std::string& path, std::span<const uint8_t> bytes) {
+        auto timer = detail::PhaseTimer(Phase::Write);
+        std::string temp;
+        HANDLE file;
+        do {
+            temp = tempPathFor(path);
+            file = CreateFileA(temp.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+        } while (file == INVALID_HANDLE_VALUE && GetLastError() == ERROR_FILE_EXISTS);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::runtime_error(std::format("Failed to open file \"{}\" for saving", temp));
+
+        bool ok = true;
+        for (size_t done = 0; ok && done < bytes.size();) {
+            DWORD written = 0;
+            auto chunk = static_cast<DWORD>(std::min<size_t>(bytes.size() - done, 1u << 30));
+            ok = WriteFile(file, bytes.data() + done, chunk, &written, nullptr);
+            done += written;
+        }
+        ok = ok && FlushFileBuffers(file);
+        CloseHandle(file);
+
+        if (!ok || !MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+            DeleteFileA(temp.c_str());
+            throw std::runtime_error(std::format("Failed to write file \"{}\"", path));
+        }
+    }
+#else
+    static void fail(const std::string& what, const std::string& path, const std::string& temp) {
+        auto error = errno;
+        unlink(temp.c_str());
+        throw std::runtime_error(std::format("Failed to {} \"{}\": {}", what, path, std::strerror(error)));
+    }
+
+    void writeFileAtomically(const std::string& path, std::span<const uint8_t> bytes) {
+        auto timer = detail::PhaseTimer(Phase::Write);
+        std::string temp;
+        int fd;
+        do {
+            temp = tempPathFor(path);
+            fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+        } while (fd < 0 && errno == EEXIST);
+        if (fd < 0)
+            throw std::runtime_error(std::format("Failed to open file \"{}\" for saving: {}", path, std::strerror(errno)));
+
+        // the replacement keeps the permissions of the file it replaces, a new file gets the umask applied
+        struct stat existing;
+        if (stat(path.c_str(), &existing) == 0 && fchmod(fd, existing.st_mode & 07777) != 0) {
+            close(fd);
+            fail("set the permissions of file", path, temp);
+        }
+
+        for (size_t done = 0; done < bytes.size();) {
+            auto written = write(fd, bytes.data() + done, bytes.size() - done);
+            if (written < 0 && errno == EINTR)
+                continue;
+            if (written < 0) {
+                close(fd);
+                fail("write file", path, temp);
+            }
+            done += written;
+        }
+        if (fsync(fd) != 0) {
+            close(fd);
+            fail("flush file", path, temp);
+        }
+        if (close(fd) != 0)
+            fail("write file", path, temp);
+        if (rename(temp.c_str(), path.c_str()) != 0)
+            fail("replace file", path, temp);
+
+        // the new directory entry is only durable once the directory is flushed too; the file is in place either
+        // way, so a failure here is not reported
+        auto dir = std::filesystem::path(path).parent_path();
+        auto dirFd = open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirFd >= 0) {
+            fsync(dirFd);
+            close(dirFd);
+        }
+    }
+#endif
+} // namespace nbt
@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace nbt {
+    // Replaces the file at `path` so that a crash at any point leaves either the old file or the new one, never a
+    // truncated mix: the bytes go to a temporary file next to it, which is flushed to disk and then renamed over
+    // the target (and the directory flushed, so the rename itself is durable). Throws std::runtime_error on failure,
+    // the target is untouched then.
+    void writeFileAtomically(const std::string& path, std::span<const uint8_t> bytes);
+} // namespace nbt
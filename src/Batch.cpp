@@ -0,0 +1,119 @@
+#include "Batch.hpp"
+
+#include <filesystem>
+#include <format>
+
+#include "AtomicFile.hpp"
+
+namespace nbt {
+    std::string BatchResult::message() const {
+        if (!error)
+            return {};
+
+        try {
+            std::rethrow_exception(error);
+        } catch (const std::exception& e) {
+            return e.what();
+        } catch (...) {
+            return "Unknown error";
+        }
+    }
+
+    // Runs work(slot, i) for every item once weight(i) bytes fit into the budget, catching errors per item.
+    template <typename Weight, typename Work>
+    static void runBatch(std::vector<BatchResult>& results, const BatchOptions& options, ThreadPool& pool, Weight&& weight, Work&& work) {
+        ByteBudget budget(options.maxInFlightBytes);
+
+        pool.parallelFor(
+            results.size(),
+            [&](size_t slot, size_t i) {
+                size_t bytes = 0;
+                try {
+                    bytes = weight(i);
+                    budget.acquire(bytes);
+                } catch (...) {
+                    results[i].error = std::current_exception();
+                    return;
+                }
+
+                try {
+                    work(slot, i);
+                } catch (...) {
+                    results[i].error = std::current_exception();
+                }
+                budget.release(bytes);
+            },
+            options.maxThreads);
+    }
+
+    static size_t fileSize(const std::string& path) {
+        std::error_code ec;
+        auto size = std::filesystem::file_size(path, ec);
+        if (ec)
+            throw std::runtime_error(std::format("Failed to open file \"{}\": {}", path, ec.message()));
+        return size;
+    }
+
+    static std::vector<BatchResult> resultsFor(std::span<const std::string> paths) {
+        std::vector<BatchResult> results(paths.size());
+        for (size_t i = 0; i < paths.size(); i++)
+            results[i].path = paths[i];
+        return results;
+    }
+
+    std::vector<BatchResult> loadFiles(std::span<const std::string> paths, const BatchCallback& callback, const BatchOptions& options,
+                                       ThreadPool& pool) {
+        auto results = resultsFor(paths);
+        // every slot parses into its own document, so the arena of the previous file is reused
+        std::vector<std::unique_ptr<Document>> docs(pool.size() + 1);
+
+        runBatch(
+            results, options, pool, [&](size_t i) { return fileSize(paths[i]); },
+            [&](size_t slot, size_t i) {
+                auto& doc = docs[slot];
+                if (!doc)
+                    doc = std::make_unique<Document>();
+                callback(i, loadFromCompressedFile(paths[i], *doc, options.encoding));
+            });
+        return results;
+    }
+
+    std::vector<BatchResult> loadFiles(std::span<const std::string> paths, std::vector<std::unique_ptr<CompoundValue>>& trees,
+                                       const BatchOptions& options, ThreadPool& pool) {
+        auto results = resultsFor(paths);
+        trees.clear();
+        trees.resize(paths.size());
+
+        runBatch(
+            results, options, pool, [&](size_t i) { return fileSize(paths[i]); },
+            [&](size_t, size_t i) { trees[i] = std::make_unique<CompoundValue>(loadFromCompressedFile(paths[i], options.encoding)); });
+        return results;
+    }
+
+    std::vector<BatchResult> saveFiles(std::span<const BatchSave> saves, const BatchOptions& options, ThreadPool& pool) {
+        std::vector<BatchResult> results(saves.size());
+        for (size_t i = 0; i < saves.size(); i++)
+            results[i].path = saves[i].path;
+        // compression output buffers, reused by every file of a slot
+        std::vector<std::vector<uint8_t>> buffers(pool.size() + 1);
+
+        runBatch(
+            results, options, pool, [&](size_t i) { return saves[i].value->serializedSize(); },
+            [&](size_t slot, size_t i) {
+                auto stats = detail::CallStats("saveFiles");
+                auto& save = saves[i];
+                auto bytes = saveToBytes(save.value, options.encoding);
+                std::span<const uint8_t> out = bytes;
+                if (options.compression != Compression::None) {
+                    auto timer = detail::PhaseTimer(Phase::Deflate);
+                    auto& backend = backendFor(options.compression);
+                    auto& buffer = buffers[slot];
+                    buffer.resize(backend.compressBound(bytes.size(), options.compression));
+                    out = std::span(buffer).first(backend.compress(bytes, buffer, options.compression, options.level));
+                }
+
+                writeFileAtomically(save.path, out);
+            });
+        return results;
+    }
+} // namespace nbt
@@ -0,0 +1,58 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <string>
+#include <span>
+#include <functional>
+#include <exception>
+
+#include "nbtpp.hpp"
+#include "ThreadPool.hpp"
+
+namespace nbt {
+    // outcome of one file of a batch, in the order the files were given
+    struct BatchResult {
+        std::string path;
+        std::exception_ptr error; // null if the file was processed
+
+        inline bool ok() const { return !error; }
+        // what() of the error, empty if there is none
+        std::string message() const;
+    };
+
+    struct BatchOptions {
+        // Upper bound of the file data being processed at once: the size on disk for loads, the uncompressed size
+        // for saves. A file larger than this still gets processed, alone. Decompressed data and trees take memory
+        // on top of it in proportion.
+        size_t maxInFlightBytes = 256 * 1024 * 1024;
+        // at most this many files at once, 0 for every slot of the pool (its threads and the calling one)
+        size_t maxThreads = 0;
+        Encoding encoding = Encoding::Java;
+        // saves only, Compression::None writes plain NBT
+        Compression compression = Compression::Gzip;
+        int level = DefaultLevel;
+    };
+
+    // Called for every loaded file with its index in the batch, concurrently from several threads. The tree is
+    // only valid during the call (its memory is reused for the next file), move out what has to be kept. It may
+    // use the same pool itself, e.g. through RegionFile::readChunks (see ThreadPool::parallelFor).
+    using BatchCallback = std::function<void(size_t index, CompoundValue& tree)>;
+
+    // A save of a batch: the tree is not owned and has to stay alive (and unmodified) until saveFiles returns.
+    struct BatchSave {
+        std::string path;
+        const Value* value;
+    };
+
+    // Loads many files (compressed or not, the format is detected like loadFromCompressedFile does) concurrently,
+    // each one read, decompressed and parsed on one of the pool's threads. A file which fails to load, or whose
+    // callback throws, gets the exception in its result and the others go on.
+    std::vector<BatchResult> loadFiles(std::span<const std::string> paths, const BatchCallback& callback, const BatchOptions& options = {},
+                                       ThreadPool& pool = ThreadPool::shared());
+    // same, keeping the trees: trees[i] is the tree of paths[i], nullptr if it failed
+    std::vector<BatchResult> loadFiles(std::span<const std::string> paths, std::vector<std::unique_ptr<CompoundValue>>& trees,
+                                       const BatchOptions& options = {}, ThreadPool& pool = ThreadPool::shared());
+    // serializes, compresses and writes many trees concurrently, see BatchOptions for the format
+    std::vector<BatchResult> saveFiles(std::span<const BatchSave> saves, const BatchOptions& options = {},
+                                       ThreadPool& pool = ThreadPool::shared());
+} // namespace nbt
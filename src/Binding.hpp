@@ -0,0 +1,362 @@
+#pragma once
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <tuple>
+#include <format>
+#include <stdexcept>
+#include <type_traits>
+
+#include "Tags.hpp"
+#include "StreamReader.hpp"
+#include "StreamWriter.hpp"
+
+namespace nbt {
+    // Compile-time mapping between NBT compounds and plain structs. Declare the fields of a struct once:
+    //
+    //     template <>
+    //     struct nbt::Binding<Player> {
+    //         static constexpr auto fields = std::make_tuple(nbt::field("Name", &Player::name),
+    //                                                        nbt::field("Health", &Player::health));
+    //     };
+    //
+    // and loadStruct / saveStruct convert between binary NBT (in any Encoding) and the struct directly, without
+    // building a tree.
+    // Supported members:
+    //  - bool and integers (by size: 1 -> Byte, 2 -> Short, 4 -> Int, 8 -> Long), float, double
+    //  - std::string
+    //  - std::vector of 1, 4 or 8 byte integers (ByteArray, IntArray or LongArray, a list of the same tag is also
+    //    accepted when reading), std::vector of anything else (List)
+    //  - std::optional of the above, an empty optional is not written and a missing key leaves it empty
+    //  - other bound structs (Compound)
+    // Unknown keys are skipped, missing keys leave the member untouched and a key with the wrong tag throws, so
+    // does data nested deeper than MaxDepth. `depth` of Codec::read is the nesting of the value being read.
+    template <typename T>
+    struct Binding;
+
+    template <typename S, typename M>
+    struct Field {
+        std::string_view key;
+        M S::*member;
+    };
+
+    template <typename S, typename M>
+    constexpr Field<S, M> field(std::string_view key, M S::*member) {
+        return {key, member};
+    }
+
+    template <typename T>
+    concept Bound = requires { Binding<T>::fields; };
+
+    template <typename T>
+    struct Codec;
+
+    namespace detail {
+        template <typename T>
+        struct IsOptional : std::false_type {};
+        template <typename T>
+        struct IsOptional<std::optional<T>> : std::true_type {};
+
+        [[noreturn]] inline void throwTagMismatch(TagID expected, TagID got) {
+            throw std::runtime_error(
+                std::format("Expected tag {}, got {}", static_cast<int>(expected), static_cast<int>(got)));
+        }
+
+        template <typename T>
+        constexpr TagID arrayTagFor() {
+            if constexpr (!std::is_integral_v<T> || std::is_same_v<T, bool>)
+                return TagID::None;
+            else if constexpr (sizeof(T) == 1)
+                return TagID::ByteArray;
+            else if constexpr (sizeof(T) == 4)
+                return TagID::IntArray;
+            else if constexpr (sizeof(T) == 8)
+                return TagID::LongArray;
+            else
+                return TagID::None;
+        }
+    } // namespace detail
+
+    template <typename T>
+        requires std::is_arithmetic_v<T>
+    struct Codec<T> {
+        static constexpr TagID id = std::is_same_v<T, bool> ? TagID::Byte
+                                    : std::is_same_v<T, float>  ? TagID::Float
+                                    : std::is_same_v<T, double> ? TagID::Double
+                                    : sizeof(T) == 1            ? TagID::Byte
+                                    : sizeof(T) == 2            ? TagID::Short
+                                    : sizeof(T) == 4            ? TagID::Int
+                                                                : TagID::Long;
+        // the payload type of the tag, e.g. an uint16_t is written as a short (and not as a varint string length)
+        using Wire = std::conditional_t<std::is_floating_point_v<T>, T,
+                                        std::conditional_t<id == TagID::Byte, char,
+                                                           std::conditional_t<id == TagID::Short, short,
+                                                                              std::conditional_t<id == TagID::Int, int, long long>>>>;
+        // whether the member type itself has the same layout as the payload type, so arrays can be read in bulk
+        template <Encoding E>
+        static constexpr bool sameLayout = sizeof(T) == sizeof(Wire) && isVarint<E, T> == isVarint<E, Wire>;
+
+        template <Encoding E>
+        static void read(BasicStreamReader<E>& reader, TagID tag, T& val, size_t = 0) {
+            if (tag != id)
+                detail::throwTagMismatch(id, tag);
+            if constexpr (std::is_same_v<T, bool>)
+                val = checkedRead<char>(reader) != 0;
+            else
+                val = static_cast<T>(checkedRead<Wire>(reader));
+        }
+
+        template <Encoding E>
+        static void write(BasicStreamWriter<E>& writer, const T& val) {
+            if constexpr (std::is_same_v<T, bool>)
+                writer << (char)val;
+            else
+                writer << static_cast<Wire>(val);
+        }
+    };
+
+    template <>
+    struct Codec<std::string> {
+        static constexpr TagID id = TagID::String;
+
+        template <Encoding E>
+        static void read(BasicStreamReader<E>& reader, TagID tag, std::string& val, size_t = 0) {
+            if (tag != id)
+                detail::throwTagMismatch(id, tag);
+            auto len = checkedRead<uint16_t>(reader);
+            ensureAvailable(reader, len);
+            val.assign((const char*)reader.remaining().data(), len);
+            reader.skip(len);
+        }
+
+        template <Encoding E>
+        static void write(BasicStreamWriter<E>& writer, const std::string& val) {
+            writer.writeStr(val);
+        }
+    };
+
+    template <typename T>
+    struct Codec<std::vector<T>> {
+        static_assert(!std::is_same_v<T, bool>, "std::vector<bool> can not be bound, use std::vector<char>");
+
+        static constexpr TagID arrayID = detail::arrayTagFor<T>();
+        static constexpr TagID id = arrayID != TagID::None ? arrayID : TagID::List;
+
+        template <Encoding E>
+        static void read(BasicStreamReader<E>& reader, TagID tag, std::vector<T>& val, size_t depth = 0) {
+            if (tag == arrayID) {
+                readItems(reader, Codec<T>::id, checkedRead<uint32_t>(reader), val, depth);
+                return;
+            }
+            if (tag != TagID::List)
+                detail::throwTagMismatch(id, tag);
+
+            auto itemsID = checkedRead<TagID>(reader);
+            auto len = checkedRead<uint32_t>(reader);
+            if (len && itemsID != Codec<T>::id)
+                detail::throwTagMismatch(Codec<T>::id, itemsID);
+
+            readItems(reader, itemsID, len, val, depth);
+        }
+
+        template <Encoding E>
+        static void write(BasicStreamWriter<E>& writer, const std::vector<T>& val) {
+            if constexpr (arrayID == TagID::None)
+                writer << Codec<T>::id;
+            writer << (int)val.size();
+
+            if constexpr (bulk<E>()) {
+                writer.writeArray(std::span<const T>(val));
+            } else {
+                for (const auto& item : val)
+                    Codec<T>::write(writer, item);
+            }
+        }
+
+      private:
+        // numbers which are laid out like their payload type are copied in one go
+        template <Encoding E>
+        static constexpr bool bulk() {
+            if constexpr (std::is_arithmetic_v<T>)
+                return Codec<T>::template sameLayout<E>;
+            else
+                return false;
+        }
+
+        // fewest bytes an item takes, a bogus length is rejected before allocating anything
+        template <Encoding E>
+        static constexpr size_t minItemSize() {
+            if constexpr (std::is_arithmetic_v<T>)
+                return minEncodedSize<E, typename Codec<T>::Wire>();
+            else
+                return 1;
+        }
+
+        template <Encoding E>
+        static void readItems(BasicStreamReader<E>& reader, TagID itemsID, size_t len, std::vector<T>& val, size_t depth) {
+            if (!reader.isStreaming()) {
+                ensureAvailable(reader, len * minItemSize<E>());
+                val.resize(len);
+                readItems(reader, itemsID, std::span<T>(val), depth);
+                return;
+            }
+
+            // a streaming reader can't tell how much is left, the vector grows with what was actually read
+            val.clear();
+            for (size_t done = 0; done < len;) {
+                auto count = std::min(len - done, std::max<size_t>(done, 1024));
+                val.resize(done + count);
+                readItems(reader, itemsID, std::span<T>(val).subspan(done, count), depth);
+                done += count;
+            }
+        }
+
+        template <Encoding E>
+        static void readItems(BasicStreamReader<E>& reader, TagID itemsID, std::span<T> items, size_t depth) {
+            if constexpr (bulk<E>()) {
+                if (!reader.readArray(items))
+                    throw std::runtime_error("Unexpected end of data");
+            } else if constexpr (std::is_arithmetic_v<T>) {
+                // e.g. uint16_t items of a Short list in the network encoding
+                for (auto& item : items)
+                    item = static_cast<T>(checkedRead<typename Codec<T>::Wire>(reader));
+            } else {
+                for (auto& item : items)
+                    Codec<T>::read(reader, itemsID, item, depth + 1);
+            }
+        }
+    };
+
+    template <typename T>
+    struct Codec<std::optional<T>> {
+        static constexpr TagID id = Codec<T>::id;
+
+        template <Encoding E>
+        static void read(BasicStreamReader<E>& reader, TagID tag, std::optional<T>& val, size_t depth = 0) {
+            Codec<T>::read(reader, tag, val.emplace(), depth);
+        }
+
+        template <Encoding E>
+        static void write(BasicStreamWriter<E>& writer, const std::optional<T>& val) {
+            Codec<T>::write(writer, *val);
+        }
+    };
+
+    template <Bound T>
+    struct Codec<T> {
+        static constexpr TagID id = TagID::Compound;
+
+        template <Encoding E>
+        static void read(BasicStreamReader<E>& reader, TagID tag, T& val, size_t depth = 0) {
+            if (tag != id)
+                detail::throwTagMismatch(id, tag);
+            // a struct holding a vector of itself recurses once per level of the input
+            if (depth >= MaxDepth)
+                throw std::runtime_error(std::format("Nesting deeper than {}", MaxDepth));
+
+            while (true) {
+                auto itemTag = checkedRead<TagID>(reader);
+                if (itemTag == TagID::End)
+                    break;
+
+                auto len = checkedRead<uint16_t>(reader);
+                ensureAvailable(reader, len);
+                auto key = reader.remaining().data();
+
+                // the field list is unrolled at compile time, most keys are rejected by their length alone
+                auto found = std::apply(
+                    [&](const auto&... fields) {
+                        return (readField(reader, itemTag, key, len, fields, val, depth + 1) || ...);
+                    },
+                    Binding<T>::fields);
+                if (!found) {
+                    reader.skip(len);
+                    skipPayload(reader, itemTag, depth + 1);
+                }
+            }
+        }
+
+        template <Encoding E>
+        static void write(BasicStreamWriter<E>& writer, const T& val) {
+            std::apply([&](const auto&... fields) { (writeField(writer, fields, val), ...); }, Binding<T>::fields);
+            writer << TagID::End;
+        }
+
+      private:
+        template <typename M, Encoding E>
+        static bool readField(BasicStreamReader<E>& reader, TagID tag, const uint8_t* key, size_t len, const Field<T, M>& field, T& val,
+                              size_t depth) {
+            if (field.key.size() != len || memcmp(key, field.key.data(), len) != 0)
+                return false;
+
+            reader.skip(len);
+            try {
+                Codec<M>::read(reader, tag, val.*field.member, depth);
+            } catch (const std::runtime_error& e) {
+                throw std::runtime_error(std::format("{}: {}", field.key, e.what()));
+            }
+            return true;
+        }
+
+        template <typename M, Encoding E>
+        static void writeField(BasicStreamWriter<E>& writer, const Field<T, M>& field, const T& val) {
+            const auto& member = val.*field.member;
+            if constexpr (detail::IsOptional<M>::value) {
+                if (!member)
+                    return;
+            }
+
+            writer << Codec<M>::id;
+            writer.writeStr(field.key);
+            Codec<M>::write(writer, member);
+        }
+    };
+
+    // reads a whole NBT file (the root compound) into a bound struct
+    template <Bound T, Encoding E>
+    void loadStruct(BasicStreamReader<E>& reader, T& val) {
+        if (checkedRead<TagID>(reader) != TagID::Compound)
+            throw std::runtime_error("Root tag is not a compound");
+        checkedSkip(reader, checkedRead<uint16_t>(reader));
+        Codec<T>::read(reader, TagID::Compound, val);
+    }
+
+    template <Bound T>
+    T loadStruct(std::span<uint8_t> bytes, Encoding encoding = Encoding::Java) {
+        T val {};
+        visitEncoding(encoding, [&](auto e) {
+            auto r = BasicStreamReader<e.value>(bytes);
+            loadStruct(r, val);
+        });
+        return val;
+    }
+
+    template <Bound T>
+    T loadStruct(StreamSource& source, Encoding encoding = Encoding::Java) {
+        T val {};
+        visitEncoding(encoding, [&](auto e) {
+            auto r = BasicStreamReader<e.value>(source);
+            loadStruct(r, val);
+        });
+        return val;
+    }
+
+    // writes a bound struct as a whole NBT file, the same layout saveToBytes produces
+    template <Bound T, Encoding E>
+    void saveStruct(BasicStreamWriter<E>& writer, const T& val, std::string_view rootName = "") {
+        writer << TagID::Compound;
+        writer.writeStr(rootName);
+        Codec<T>::write(writer, val);
+    }
+
+    template <Bound T>
+    std::vector<uint8_t> saveStruct(const T& val, std::string_view rootName = "", Encoding encoding = Encoding::Java) {
+        return visitEncoding(encoding, [&](auto e) {
+            BasicStreamWriter<e.value> w;
+            saveStruct(w, val, rootName);
+            return w.takeBytes();
+        });
+    }
+} // namespace nbt
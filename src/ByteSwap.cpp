@@ -0,0 +1,130 @@
+#include "ByteSwap.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define nbtpp_x86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang need the target attribute to emit instructions newer than the baseline, MSVC doesn't
+#if defined(nbtpp_x86) && (defined(__GNUC__) || defined(__clang__))
+#define nbtpp_target(x) __attribute__((target(x)))
+#else
+#define nbtpp_target(x)
+#endif
+
+namespace nbt {
+    template <typename U>
+    static void swapScalar(uint8_t* data, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            U val;
+            memcpy(&val, data + i * sizeof(U), sizeof(U));
+            val = std::byteswap(val);
+            memcpy(data + i * sizeof(U), &val, sizeof(U));
+        }
+    }
+
+    static void swapScalar(uint8_t* data, size_t count, size_t size) {
+        switch (size) {
+        case 2:
+            swapScalar<uint16_t>(data, count);
+            break;
+        case 4:
+            swapScalar<uint32_t>(data, count);
+            break;
+        case 8:
+            swapScalar<uint64_t>(data, count);
+            break;
+        }
+    }
+
+#ifdef nbtpp_x86
+    // shuffle masks reversing every 2, 4 or 8 byte group of a 16 byte lane
+    alignas(16) static const uint8_t shuffle2[16] = {1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14};
+    alignas(16) static const uint8_t shuffle4[16] = {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+    alignas(16) static const uint8_t shuffle8[16] = {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8};
+
+    static const uint8_t* maskFor(size_t size) {
+        return size == 2 ? shuffle2 : size == 4 ? shuffle4 : shuffle8;
+    }
+
+    nbtpp_target("avx2") static void swapAVX2(uint8_t* data, size_t count, size_t size) {
+        auto lane = _mm_load_si128((const __m128i*)maskFor(size));
+        auto mask = _mm256_broadcastsi128_si256(lane);
+        auto bytes = count * size;
+        size_t i = 0;
+        for (; i + 64 <= bytes; i += 64) {
+            auto a = _mm256_loadu_si256((const __m256i*)(data + i));
+            auto b = _mm256_loadu_si256((const __m256i*)(data + i + 32));
+            _mm256_storeu_si256((__m256i*)(data + i), _mm256_shuffle_epi8(a, mask));
+            _mm256_storeu_si256((__m256i*)(data + i + 32), _mm256_shuffle_epi8(b, mask));
+        }
+        for (; i + 16 <= bytes; i += 16) {
+            auto a = _mm_loadu_si128((const __m128i*)(data + i));
+            _mm_storeu_si128((__m128i*)(data + i), _mm_shuffle_epi8(a, lane));
+        }
+        swapScalar(data + i, (bytes - i) / size, size);
+    }
+
+    nbtpp_target("ssse3") static void swapSSSE3(uint8_t* data, size_t count, size_t size) {
+        auto mask = _mm_load_si128((const __m128i*)maskFor(size));
+        auto bytes = count * size;
+        size_t i = 0;
+        for (; i + 16 <= bytes; i += 16) {
+            auto a = _mm_loadu_si128((const __m128i*)(data + i));
+            _mm_storeu_si128((__m128i*)(data + i), _mm_shuffle_epi8(a, mask));
+        }
+        swapScalar(data + i, (bytes - i) / size, size);
+    }
+
+    enum class SwapKernel {
+        Scalar,
+        SSSE3,
+        AVX2
+    };
+
+    static SwapKernel detectKernel() {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        auto maxLeaf = info[0];
+        __cpuid(info, 1);
+        bool ssse3 = info[2] & (1 << 9);
+        bool avx = (info[2] & (1 << 28)) && (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+        bool avx2 = false;
+        if (maxLeaf >= 7) {
+            __cpuidex(info, 7, 0);
+            avx2 = avx && (info[1] & (1 << 5));
+        }
+#else
+        __builtin_cpu_init();
+        bool ssse3 = __builtin_cpu_supports("ssse3");
+        bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+        return avx2 ? SwapKernel::AVX2 : ssse3 ? SwapKernel::SSSE3 : SwapKernel::Scalar;
+    }
+#endif
+
+    void swapBytesInPlace(void* data, size_t count, size_t size) {
+        auto bytes = (uint8_t*)data;
+#ifdef nbtpp_x86
+        static const auto kernel = detectKernel();
+        // not worth setting up the vector path for a couple of elements
+        if (count * size >= 32) {
+            switch (kernel) {
+            case SwapKernel::AVX2:
+                swapAVX2(bytes, count, size);
+                return;
+            case SwapKernel::SSSE3:
+                swapSSSE3(bytes, count, size);
+                return;
+            default:
+                break;
+            }
+        }
+#endif
+        swapScalar(bytes, count, size);
+    }
+} // namespace nbt
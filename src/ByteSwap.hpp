@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <bit>
+#include <type_traits>
+
+namespace nbt {
+    // reverses the bytes of any trivially copyable value, floats included
+    template <typename T>
+    inline T swapBytes(T val) {
+        if constexpr (sizeof(T) == 1) {
+            return val;
+        } else {
+            using U = std::conditional_t<sizeof(T) == 2, uint16_t, std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>;
+            static_assert(sizeof(T) == sizeof(U), "swapBytes only supports 1, 2, 4 and 8 byte values");
+            return std::bit_cast<T>(std::byteswap(std::bit_cast<U>(val)));
+        }
+    }
+
+    // Swaps `count` elements of `size` (2, 4 or 8) bytes in place. Uses AVX2 or SSSE3 when the CPU supports it.
+    void swapBytesInPlace(void* data, size_t count, size_t size);
+} // namespace nbt
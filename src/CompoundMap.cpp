@@ -0,0 +1,204 @@
+#include "CompoundMap.hpp"
+
+#include <cstring>
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <stdexcept>
+#include <format>
+
+namespace nbt {
+    size_t CompoundMap::findIndex(std::string_view key) const {
+        if (m_index.empty()) {
+            for (size_t i = 0; i < m_entries.size(); i++) {
+                const auto& name = m_entries[i].first;
+                if (name.size() == key.size() && memcmp(name.data(), key.data(), key.size()) == 0)
+                    return i;
+            }
+            return npos;
+        }
+
+        auto hash = hashKey(key);
+        auto mask = m_index.size() - 1;
+        for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+            auto entry = m_index[slot];
+            if (!entry)
+                return npos;
+            const auto& name = m_entries[entry - 1].first;
+            if (name.hash() == hash && name == key)
+                return entry - 1;
+        }
+    }
+
+    size_t CompoundMap::findIndex(Key key) const {
+        // interned keys mostly compare by pointer and hash without touching the characters
+        if (m_index.empty()) {
+            for (size_t i = 0; i < m_entries.size(); i++) {
+                if (m_entries[i].first == key)
+                    return i;
+            }
+            return npos;
+        }
+
+        auto mask = m_index.size() - 1;
+        for (auto slot = key.hash() & mask;; slot = (slot + 1) & mask) {
+            auto entry = m_index[slot];
+            if (!entry)
+                return npos;
+            if (m_entries[entry - 1].first == key)
+                return entry - 1;
+        }
+    }
+
+    CompoundMap::iterator CompoundMap::find(std::string_view key) {
+        auto i = findIndex(key);
+        return i == npos ? end() : begin() + i;
+    }
+
+    CompoundMap::const_iterator CompoundMap::find(std::string_view key) const {
+        auto i = findIndex(key);
+        return i == npos ? end() : begin() + i;
+    }
+
+    Value*& CompoundMap::operator[](std::string_view key) {
+        return emplace(key, nullptr).first->second;
+    }
+
+    Value*& CompoundMap::at(std::string_view key) {
+        auto i = findIndex(key);
+        if (i == npos)
+            throw std::out_of_range(std::format("No key \"{}\" in the compound", key));
+        return m_entries[i].second;
+    }
+
+    Value* CompoundMap::at(std::string_view key) const {
+        auto i = findIndex(key);
+        if (i == npos)
+            throw std::out_of_range(std::format("No key \"{}\" in the compound", key));
+        return m_entries[i].second;
+    }
+
+    std::pair<CompoundMap::iterator, bool> CompoundMap::insert_or_assign(std::string_view key, Value* value) {
+        auto [it, inserted] = emplace(key, value);
+        if (!inserted)
+            it->second = value;
+        return {it, inserted};
+    }
+
+    std::pair<CompoundMap::iterator, bool> CompoundMap::insert_or_assign(Key key, Value* value) {
+        auto [it, inserted] = emplace(key, value);
+        if (!inserted)
+            it->second = value;
+        return {it, inserted};
+    }
+
+    CompoundMap::CompoundMap(const CompoundMap& other, std::pmr::memory_resource* resource)
+        : m_entries(other.m_entries, resource), m_index(other.m_index, resource), m_keys(&keyTableFor(resource)) {
+        // the index only depends on the hashes of the keys, so it stays valid in another key table
+        for (auto& [key, _] : m_entries) {
+            if (m_keys != other.m_keys || key.isOwned())
+                key = adopt(key);
+        }
+    }
+
+    CompoundMap::~CompoundMap() {
+        releaseKeys();
+    }
+
+    std::pair<CompoundMap::iterator, bool> CompoundMap::emplace(std::string_view key, Value* value) {
+        if (auto i = findIndex(key); i != npos)
+            return {begin() + i, false};
+
+        append(adopt(key, hashKey(key)), value);
+        return {end() - 1, true};
+    }
+
+    std::pair<CompoundMap::iterator, bool> CompoundMap::emplace(Key key, Value* value) {
+        if (auto i = findIndex(key); i != npos)
+            return {begin() + i, false};
+
+        append(adopt(key), value);
+        return {end() - 1, true};
+    }
+
+    void CompoundMap::append(Key key, Value* value) {
+        // skips the 1 -> 2 -> 4 regrowth most compounds would go through
+        if (m_entries.capacity() == 0)
+            m_entries.reserve(4);
+        m_entries.emplace_back(key, value);
+
+        if (m_entries.size() <= IndexThreshold)
+            return;
+        // keep the index at most half full
+        if (m_entries.size() * 2 > m_index.size())
+            rebuildIndex();
+        else
+            indexEntry(m_entries.size() - 1);
+    }
+
+    size_t CompoundMap::erase(std::string_view key) {
+        auto i = findIndex(key);
+        if (i == npos)
+            return 0;
+
+        erase(begin() + i);
+        return 1;
+    }
+
+    CompoundMap::iterator CompoundMap::erase(const_iterator pos) {
+        auto i = pos - m_entries.cbegin();
+        KeyTable::releaseOwned(pos->first, m_entries.get_allocator().resource());
+        m_entries.erase(pos);
+
+        // the positions after the removed entry have shifted
+        if (m_entries.size() <= IndexThreshold)
+            m_index.clear();
+        else
+            rebuildIndex();
+
+        return begin() + i;
+    }
+
+    void CompoundMap::clear() {
+        releaseKeys();
+        m_entries.clear();
+        m_index.clear();
+    }
+
+    Key CompoundMap::adopt(std::string_view key, size_t hash) {
+        if (auto interned = m_keys->tryIntern(key, hash))
+            return *interned;
+        return KeyTable::makeOwned(key, hash, m_entries.get_allocator().resource());
+    }
+
+    Key CompoundMap::adopt(Key key) {
+        if (m_keys->owns(key) || KeyTable::builtin().owns(key) || KeyTable::shared().owns(key))
+            return key;
+        return adopt(key.view(), key.hash());
+    }
+
+    void CompoundMap::releaseKeys() {
+        auto resource = m_entries.get_allocator().resource();
+        for (auto& [key, _] : m_entries)
+            KeyTable::releaseOwned(key, resource);
+    }
+
+    void CompoundMap::reserve(size_t count) {
+        m_entries.reserve(count);
+    }
+
+    void CompoundMap::rebuildIndex() {
+        auto slots = std::bit_ceil(m_entries.size() * 2);
+        m_index.assign(std::max<size_t>(slots, IndexThreshold * 4), 0);
+        for (size_t i = 0; i < m_entries.size(); i++)
+            indexEntry(i);
+    }
+
+    void CompoundMap::indexEntry(size_t entry) {
+        auto mask = m_index.size() - 1;
+        auto slot = m_entries[entry].first.hash() & mask;
+        while (m_index[slot])
+            slot = (slot + 1) & mask;
+        m_index[slot] = uint32_t(entry + 1);
+    }
+} // namespace nbt
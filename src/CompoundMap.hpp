@@ -0,0 +1,96 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <memory_resource>
+
+#include "KeyTable.hpp"
+
+namespace nbt {
+    class Value;
+
+    // Insertion-ordered map from keys to the children of a compound. Most compounds have a handful of keys, so the
+    // entries are a flat vector searched linearly (comparing lengths first). Above IndexThreshold entries an
+    // open-addressing index of entry positions is kept next to them. Lookups take any string_view, no temporary
+    // strings are built, and iteration (so serialization too) follows insertion order.
+    // Keys are interned in the KeyTable of the resource (see keyTableFor), an entry is just two pointers. Past the
+    // limit of the shared table the map owns its new keys, so a Key taken from a map is only valid as long as it is.
+    // Like a vector, inserting or erasing invalidates iterators and references into the map.
+    class CompoundMap {
+      public:
+        using value_type = std::pair<Key, Value*>;
+        using iterator = std::pmr::vector<value_type>::iterator;
+        using const_iterator = std::pmr::vector<value_type>::const_iterator;
+
+        static constexpr size_t IndexThreshold = 16;
+
+        CompoundMap(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : m_entries(resource), m_index(resource), m_keys(&keyTableFor(resource)) {}
+        // `keys` has to be keyTableFor(resource), e.g. the table of the parent while decoding
+        CompoundMap(KeyTable& keys, std::pmr::memory_resource* resource)
+            : m_entries(resource), m_index(resource), m_keys(&keys) {}
+        // copies the entries (the value pointers, not the values) onto another resource
+        CompoundMap(const CompoundMap& other, std::pmr::memory_resource* resource);
+        // like a pmr container, a copy uses the default resource
+        CompoundMap(const CompoundMap& other) : CompoundMap(other, std::pmr::get_default_resource()) {}
+        CompoundMap(CompoundMap&& other) = default;
+        CompoundMap& operator=(const CompoundMap&) = delete;
+        ~CompoundMap();
+
+        inline size_t size() const { return m_entries.size(); }
+        inline bool empty() const { return m_entries.empty(); }
+
+        inline iterator begin() { return m_entries.begin(); }
+        inline iterator end() { return m_entries.end(); }
+        inline const_iterator begin() const { return m_entries.begin(); }
+        inline const_iterator end() const { return m_entries.end(); }
+
+        iterator find(std::string_view key);
+        const_iterator find(std::string_view key) const;
+        inline bool contains(std::string_view key) const { return findIndex(key) != npos; }
+
+        // inserts a nullptr value if the key is missing
+        Value*& operator[](std::string_view key);
+        // throws std::out_of_range if the key is missing
+        Value*& at(std::string_view key);
+        Value* at(std::string_view key) const;
+
+        // the bool is true if the key was inserted, false if an existing value was replaced (the old one is not freed)
+        std::pair<iterator, bool> insert_or_assign(std::string_view key, Value* value);
+        std::pair<iterator, bool> insert_or_assign(Key key, Value* value);
+        // does nothing if the key exists already; a key which is not in this map's table, the shared or the built-in
+        // one (e.g. from a Document or an owned key of another map) is copied
+        std::pair<iterator, bool> emplace(std::string_view key, Value* value);
+        std::pair<iterator, bool> emplace(Key key, Value* value);
+
+        // keeps the order of the remaining entries, the removed value is not freed
+        size_t erase(std::string_view key);
+        iterator erase(const_iterator pos);
+
+        void clear();
+        void reserve(size_t count);
+
+        inline KeyTable& keys() const { return *m_keys; }
+
+      private:
+        static constexpr size_t npos = size_t(-1);
+
+        size_t findIndex(std::string_view key) const;
+        size_t findIndex(Key key) const;
+        // the key interned in m_keys, or owned by the map once the table is full
+        Key adopt(std::string_view key, size_t hash);
+        // `key` itself if it lives as long as the map, otherwise a copy like above
+        Key adopt(Key key);
+        void releaseKeys();
+        void append(Key key, Value* value);
+        void rebuildIndex();
+        void indexEntry(size_t entry);
+
+        std::pmr::vector<value_type> m_entries;
+        // entry position + 1 per slot, 0 marks an empty slot; empty while the map is small
+        std::pmr::vector<uint32_t> m_index;
+        KeyTable* m_keys;
+    };
+} // namespace nbt
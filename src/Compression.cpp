@@ -0,0 +1,116 @@
+#include "Compression.hpp"
+
+#include <mutex>
+#include <format>
+#include <stdexcept>
+
+#include "Stats.hpp"
+
+namespace nbt {
+    Compression detectCompression(std::span<const uint8_t> data) {
+        if (data.size() >= 4) {
+            if (data[0] == 0x28 && data[1] == 0xB5 && data[2] == 0x2F && data[3] == 0xFD)
+                return Compression::Zstd;
+            if (data[0] == 0x04 && data[1] == 0x22 && data[2] == 0x4D && data[3] == 0x18)
+                return Compression::Lz4;
+        }
+        if (data.size() >= 2) {
+            if (data[0] == 0x1F && data[1] == 0x8B)
+                return Compression::Gzip;
+            // deflate with a window of at most 32 KiB and a header checksum which is a multiple of 31
+            if ((data[0] & 0x0F) == 8 && (data[0] >> 4) <= 7 && ((data[0] << 8) | data[1]) % 31 == 0)
+                return Compression::Zlib;
+        }
+        return Compression::None;
+    }
+
+    std::string_view compressionName(Compression format) {
+        switch (format) {
+        case Compression::None:
+            return "none";
+        case Compression::Gzip:
+            return "gzip";
+        case Compression::Zlib:
+            return "zlib";
+        case Compression::Zstd:
+            return "zstd";
+        case Compression::Lz4:
+            return "lz4";
+        default:
+            return "unknown";
+        }
+    }
+
+    std::unique_ptr<StreamSource> CompressionBackend::stream(std::span<const uint8_t> src, Compression format) const {
+        throw std::runtime_error(std::format("The {} backend can't decompress {} while parsing", name(), compressionName(format)));
+    }
+
+    namespace {
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<CompressionBackend>> backends;
+
+            Registry() {
+#ifdef nbtpp_libdeflate
+                backends.push_back(libdeflateBackend());
+#endif
+#ifdef nbtpp_zlib
+                backends.push_back(zlibBackend());
+#endif
+#ifdef nbtpp_zstd
+                backends.push_back(zstdBackend());
+#endif
+#ifdef nbtpp_lz4
+                backends.push_back(lz4Backend());
+#endif
+            }
+        };
+
+        Registry& registry() {
+            static Registry r;
+            return r;
+        }
+    } // namespace
+
+    void registerBackend(std::shared_ptr<CompressionBackend> backend) {
+        auto& r = registry();
+        std::lock_guard lock(r.mutex);
+        r.backends.insert(r.backends.begin(), std::move(backend));
+    }
+
+    CompressionBackend& backendFor(Compression format) {
+        auto& r = registry();
+        std::lock_guard lock(r.mutex);
+        // backends are never unregistered, so the reference stays valid
+        for (const auto& backend : r.backends) {
+            if (backend->supports(format))
+                return *backend;
+        }
+        throw std::runtime_error(std::format("No compression backend for {}, compile nbtpp with one!", compressionName(format)));
+    }
+
+    std::vector<std::shared_ptr<CompressionBackend>> compressionBackends() {
+        auto& r = registry();
+        std::lock_guard lock(r.mutex);
+        return r.backends;
+    }
+
+    std::vector<uint8_t> compressData(std::span<const uint8_t> data, Compression format, int level) {
+        if (format == Compression::None)
+            return {data.begin(), data.end()};
+
+        auto timer = detail::PhaseTimer(Phase::Deflate);
+        auto& backend = backendFor(format);
+        std::vector<uint8_t> out(backend.compressBound(data.size(), format));
+        out.resize(backend.compress(data, out, format, level));
+        return out;
+    }
+
+    std::vector<uint8_t> decompressData(std::span<const uint8_t> data) {
+        auto format = detectCompression(data);
+        if (format == Compression::None)
+            return {data.begin(), data.end()};
+        auto timer = detail::PhaseTimer(Phase::Inflate);
+        return backendFor(format).decompress(data, format);
+    }
+} // namespace nbt
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <memory>
+#include <string_view>
+
+#include "StreamSource.hpp"
+
+namespace nbt {
+    enum class Compression : uint8_t {
+        None,
+        Gzip, // what the game uses for level.dat and player data
+        Zlib, // what region chunks use
+        Zstd,
+        Lz4 // the LZ4 frame format
+    };
+
+    // lets the backend pick its own default level
+    constexpr int DefaultLevel = -1;
+
+    // Detects the format from its magic bytes. Anything unrecognized is None, uncompressed NBT starts with a tag.
+    Compression detectCompression(std::span<const uint8_t> data);
+    std::string_view compressionName(Compression format);
+
+    // A compression library. Backends work on whole buffers, a backend which can also decompress while the data
+    // is being parsed (bounded memory for huge files) says so with canStream. Implementations have to be
+    // thread-safe, the same backend is used from every thread.
+    class CompressionBackend {
+      public:
+        virtual ~CompressionBackend() {}
+
+        virtual std::string_view name() const = 0;
+        virtual bool supports(Compression format) const = 0;
+
+        // upper bound of the compressed size of `len` bytes
+        virtual size_t compressBound(size_t len, Compression format) const = 0;
+        // compresses a whole buffer into dst, which has to be at least compressBound long; returns the compressed
+        // size. The level is passed to the library as is, DefaultLevel picks the library default.
+        virtual size_t compress(std::span<const uint8_t> src, std::span<uint8_t> dst, Compression format, int level) const = 0;
+        virtual std::vector<uint8_t> decompress(std::span<const uint8_t> src, Compression format) const = 0;
+
+        virtual bool canStream(Compression format) const { return false; }
+        // decompresses while a StreamReader consumes the output, src has to outlive the source
+        virtual std::unique_ptr<StreamSource> stream(std::span<const uint8_t> src, Compression format) const;
+    };
+
+    // Backends for a format are tried in order: registered ones (the latest first), then the built-in ones.
+    // libdeflate comes before zlib, it is several times faster on whole buffers but does not stream.
+    void registerBackend(std::shared_ptr<CompressionBackend> backend);
+    // throws std::runtime_error if nbtpp was compiled without a backend for the format
+    CompressionBackend& backendFor(Compression format);
+    // every available backend, in the order they are tried
+    std::vector<std::shared_ptr<CompressionBackend>> compressionBackends();
+
+    // built-in backends, only present when nbtpp is compiled with the library
+#ifdef nbtpp_zlib
+    std::shared_ptr<CompressionBackend> zlibBackend();
+#endif
+#ifdef nbtpp_libdeflate
+    std::shared_ptr<CompressionBackend> libdeflateBackend();
+#endif
+#ifdef nbtpp_zstd
+    std::shared_ptr<CompressionBackend> zstdBackend();
+#endif
+#ifdef nbtpp_lz4
+    std::shared_ptr<CompressionBackend> lz4Backend();
+#endif
+
+    // whole-buffer helpers going through backendFor; decompressData detects the format and passes None through
+    std::vector<uint8_t> compressData(std::span<const uint8_t> data, Compression format, int level = DefaultLevel);
+    std::vector<uint8_t> decompressData(std::span<const uint8_t> data);
+} // namespace nbt
@@ -0,0 +1,353 @@
+#include "Compression.hpp"
+
+#include <array>
+#include <format>
+#include <cstring>
+#include <stdexcept>
+
+#include "InflateSource.hpp"
+#ifdef nbtpp_zlib
+#include <zlib.h>
+#endif
+#ifdef nbtpp_libdeflate
+#include <libdeflate.h>
+#endif
+#ifdef nbtpp_zstd
+#include <zstd.h>
+#endif
+#ifdef nbtpp_lz4
+#include <lz4frame.h>
+#endif
+
+namespace nbt {
+    // deflate can't do better than about 1:1032, a bigger output means the data is bogus
+    [[maybe_unused]] static constexpr size_t MaxDeflateRatio = 1032;
+    // a zstd block holds at most 128 KiB and takes at least 4 bytes (an RLE block)
+    [[maybe_unused]] static constexpr size_t MaxZstdRatio = 32768;
+    // an LZ4 match grows by at most 255 bytes per input byte
+    [[maybe_unused]] static constexpr size_t MaxLz4Ratio = 256;
+
+    // the size a gzip member says its data has (modulo 4 GiB), used to size the output up front
+    [[maybe_unused]] static size_t gzipSizeHint(std::span<const uint8_t> src) {
+        if (src.size() < 18)
+            return 0;
+        auto p = src.data() + src.size() - 4;
+        auto size = size_t(p[0]) | size_t(p[1]) << 8 | size_t(p[2]) << 16 | size_t(p[3]) << 24;
+        return size <= src.size() * MaxDeflateRatio ? size : 0;
+    }
+
+#ifdef nbtpp_zlib
+    namespace {
+        class ZlibBackend : public CompressionBackend {
+          public:
+            std::string_view name() const override { return "zlib"; }
+            bool supports(Compression format) const override {
+                return format == Compression::Gzip || format == Compression::Zlib;
+            }
+
+            size_t compressBound(size_t len, Compression format) const override {
+                // the gzip header and trailer take 12 bytes more than the zlib ones
+                return ::compressBound(len) + (format == Compression::Gzip ? 12 : 0);
+            }
+
+            size_t compress(std::span<const uint8_t> src, std::span<uint8_t> dst, Compression format, int level) const override {
+                z_stream strm {};
+                auto windowBits = format == Compression::Gzip ? 16 + MAX_WBITS : MAX_WBITS;
+                if (deflateInit2(&strm, level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+                    throw std::runtime_error("Failed to create a zlib stream");
+
+                strm.next_in = (Bytef*)src.data();
+                strm.avail_in = src.size();
+                strm.next_out = (Bytef*)dst.data();
+                strm.avail_out = dst.size();
+
+                auto ret = deflate(&strm, Z_FINISH);
+                deflateEnd(&strm);
+                if (ret != Z_STREAM_END)
+                    throw std::runtime_error("Failed to compress the data");
+                return strm.total_out;
+            }
+
+            std::vector<uint8_t> decompress(std::span<const uint8_t> src, Compression format) const override {
+                // produce() writes straight into the output, the source needs no window of its own
+                auto source = InflateSource(src, 0);
+                // one byte more than the hint, so the end of the stream is seen without growing the buffer; zlib data
+                // ends with a checksum, not a size
+                auto hint = format == Compression::Gzip ? gzipSizeHint(src) : 0;
+                std::vector<uint8_t> out(std::max<size_t>(hint + 1, src.size() * 4));
+                size_t len = 0;
+                while (auto got = source.produce(std::span(out).subspan(len))) {
+                    len += got;
+                    if (len == out.size())
+                        out.resize(out.size() * 2);
+                }
+                out.resize(len);
+                return out;
+            }
+
+            bool canStream(Compression format) const override { return supports(format); }
+            std::unique_ptr<StreamSource> stream(std::span<const uint8_t> src, Compression format) const override {
+                return std::make_unique<InflateSource>(src);
+            }
+        };
+    } // namespace
+
+    std::shared_ptr<CompressionBackend> zlibBackend() {
+        static auto backend = std::make_shared<ZlibBackend>();
+        return backend;
+    }
+#endif
+
+#ifdef nbtpp_libdeflate
+    namespace {
+        // libdeflate (de)compressors are not thread-safe but cheap to keep around, every thread gets its own
+        struct DeflateContexts {
+            std::array<libdeflate_compressor*, 13> compressors {};
+            libdeflate_decompressor* decompressor = nullptr;
+
+            ~DeflateContexts() {
+                for (auto c : compressors) {
+                    if (c)
+                        libdeflate_free_compressor(c);
+                }
+                if (decompressor)
+                    libdeflate_free_decompressor(decompressor);
+            }
+
+            libdeflate_compressor* compressor(int level) {
+                if (level == DefaultLevel)
+                    level = 6;
+                if (level < 0 || level > 12)
+                    throw std::runtime_error(std::format("Invalid libdeflate compression level {}", level));
+
+                auto& c = compressors[level];
+                if (!c && !(c = libdeflate_alloc_compressor(level)))
+                    throw std::bad_alloc();
+                return c;
+            }
+
+            libdeflate_decompressor* decompressorFor() {
+                if (!decompressor && !(decompressor = libdeflate_alloc_decompressor()))
+                    throw std::bad_alloc();
+                return decompressor;
+            }
+        };
+
+        thread_local DeflateContexts t_deflate;
+
+        class LibdeflateBackend : public CompressionBackend {
+          public:
+            std::string_view name() const override { return "libdeflate"; }
+            bool supports(Compression format) const override {
+                return format == Compression::Gzip || format == Compression::Zlib;
+            }
+
+            size_t compressBound(size_t len, Compression format) const override {
+                auto c = t_deflate.compressor(DefaultLevel);
+                return format == Compression::Gzip ? libdeflate_gzip_compress_bound(c, len) : libdeflate_zlib_compress_bound(c, len);
+            }
+
+            size_t compress(std::span<const uint8_t> src, std::span<uint8_t> dst, Compression format, int level) const override {
+                auto c = t_deflate.compressor(level);
+                auto len = format == Compression::Gzip ? libdeflate_gzip_compress(c, src.data(), src.size(), dst.data(), dst.size())
+                                                       : libdeflate_zlib_compress(c, src.data(), src.size(), dst.data(), dst.size());
+                if (!len)
+                    throw std::runtime_error("Failed to compress the data");
+                return len;
+            }
+
+            std::vector<uint8_t> decompress(std::span<const uint8_t> src, Compression format) const override {
+                auto d = t_deflate.decompressorFor();
+                // whole-buffer inflate needs the output size, gzip stores it and zlib data just gets a bigger buffer
+                std::vector<uint8_t> out(std::max<size_t>(format == Compression::Gzip ? gzipSizeHint(src) : 0, src.size() * 4));
+                while (true) {
+                    size_t len = 0;
+                    auto ret = format == Compression::Gzip
+                                   ? libdeflate_gzip_decompress(d, src.data(), src.size(), out.data(), out.size(), &len)
+                                   : libdeflate_zlib_decompress(d, src.data(), src.size(), out.data(), out.size(), &len);
+                    if (ret == LIBDEFLATE_SUCCESS) {
+                        out.resize(len);
+                        return out;
+                    }
+                    if (ret != LIBDEFLATE_INSUFFICIENT_SPACE || out.size() > src.size() * MaxDeflateRatio)
+                        throw std::runtime_error(std::format("Invalid {} data", compressionName(format)));
+                    out.resize(out.size() * 2);
+                }
+            }
+        };
+    } // namespace
+
+    std::shared_ptr<CompressionBackend> libdeflateBackend() {
+        static auto backend = std::make_shared<LibdeflateBackend>();
+        return backend;
+    }
+#endif
+
+#ifdef nbtpp_zstd
+    namespace {
+        struct ZstdContexts {
+            ZSTD_CCtx* cctx = nullptr;
+            ZSTD_DCtx* dctx = nullptr;
+
+            ~ZstdContexts() {
+                ZSTD_freeCCtx(cctx);
+                ZSTD_freeDCtx(dctx);
+            }
+        };
+
+        thread_local ZstdContexts t_zstd;
+
+        void checkZstd(size_t code) {
+            if (ZSTD_isError(code))
+                throw std::runtime_error(std::format("Zstd error: {}", ZSTD_getErrorName(code)));
+        }
+
+        class ZstdBackend : public CompressionBackend {
+          public:
+            std::string_view name() const override { return "zstd"; }
+            bool supports(Compression format) const override { return format == Compression::Zstd; }
+
+            size_t compressBound(size_t len, Compression format) const override { return ZSTD_compressBound(len); }
+
+            // negative (fast) levels other than DefaultLevel are passed through
+            size_t compress(std::span<const uint8_t> src, std::span<uint8_t> dst, Compression format, int level) const override {
+                if (!t_zstd.cctx && !(t_zstd.cctx = ZSTD_createCCtx()))
+                    throw std::bad_alloc();
+                auto len = ZSTD_compressCCtx(t_zstd.cctx, dst.data(), dst.size(), src.data(), src.size(),
+                                             level == DefaultLevel ? ZSTD_CLEVEL_DEFAULT : level);
+                checkZstd(len);
+                return len;
+            }
+
+            std::vector<uint8_t> decompress(std::span<const uint8_t> src, Compression format) const override {
+                if (!t_zstd.dctx && !(t_zstd.dctx = ZSTD_createDCtx()))
+                    throw std::bad_alloc();
+
+                // frames written by ZSTD_compress know their size, others are decompressed as a stream
+                auto size = ZSTD_getFrameContentSize(src.data(), src.size());
+                // the size comes from the frame header, it must not allocate more than the data can hold
+                if (size == ZSTD_CONTENTSIZE_ERROR || (size != ZSTD_CONTENTSIZE_UNKNOWN && size / MaxZstdRatio > src.size()))
+                    throw std::runtime_error("Invalid zstd data");
+                if (size != ZSTD_CONTENTSIZE_UNKNOWN) {
+                    std::vector<uint8_t> out(size);
+                    auto len = ZSTD_decompressDCtx(t_zstd.dctx, out.data(), out.size(), src.data(), src.size());
+                    checkZstd(len);
+                    out.resize(len);
+                    return out;
+                }
+
+                checkZstd(ZSTD_DCtx_reset(t_zstd.dctx, ZSTD_reset_session_only));
+                std::vector<uint8_t> out(src.size() * 4);
+                ZSTD_inBuffer in {src.data(), src.size(), 0};
+                ZSTD_outBuffer output {out.data(), out.size(), 0};
+                while (true) {
+                    auto ret = ZSTD_decompressStream(t_zstd.dctx, &output, &in);
+                    checkZstd(ret);
+                    if (ret == 0)
+                        break;
+                    if (in.pos == in.size && output.pos < output.size)
+                        throw std::runtime_error("Unexpected end of zstd data");
+                    if (output.pos == output.size) {
+                        out.resize(out.size() * 2);
+                        output.dst = out.data();
+                        output.size = out.size();
+                    }
+                }
+                out.resize(output.pos);
+                return out;
+            }
+        };
+    } // namespace
+
+    std::shared_ptr<CompressionBackend> zstdBackend() {
+        static auto backend = std::make_shared<ZstdBackend>();
+        return backend;
+    }
+#endif
+
+#ifdef nbtpp_lz4
+    namespace {
+        struct Lz4Contexts {
+            LZ4F_dctx* dctx = nullptr;
+
+            ~Lz4Contexts() {
+                if (dctx)
+                    LZ4F_freeDecompressionContext(dctx);
+            }
+        };
+
+        thread_local Lz4Contexts t_lz4;
+
+        void checkLz4(size_t code) {
+            if (LZ4F_isError(code))
+                throw std::runtime_error(std::format("LZ4 error: {}", LZ4F_getErrorName(code)));
+        }
+
+        LZ4F_preferences_t lz4Preferences(size_t len, int level) {
+            LZ4F_preferences_t prefs;
+            memset(&prefs, 0, sizeof(prefs));
+            // the size goes into the frame header, so decompression can allocate once
+            prefs.frameInfo.contentSize = len;
+            prefs.frameInfo.blockSizeID = LZ4F_max4MB;
+            prefs.compressionLevel = level == DefaultLevel ? 0 : level;
+            return prefs;
+        }
+
+        class Lz4Backend : public CompressionBackend {
+          public:
+            std::string_view name() const override { return "lz4"; }
+            bool supports(Compression format) const override { return format == Compression::Lz4; }
+
+            size_t compressBound(size_t len, Compression format) const override {
+                auto prefs = lz4Preferences(len, DefaultLevel);
+                return LZ4F_compressFrameBound(len, &prefs);
+            }
+
+            size_t compress(std::span<const uint8_t> src, std::span<uint8_t> dst, Compression format, int level) const override {
+                auto prefs = lz4Preferences(src.size(), level);
+                auto len = LZ4F_compressFrame(dst.data(), dst.size(), src.data(), src.size(), &prefs);
+                checkLz4(len);
+                return len;
+            }
+
+            std::vector<uint8_t> decompress(std::span<const uint8_t> src, Compression format) const override {
+                if (!t_lz4.dctx)
+                    checkLz4(LZ4F_createDecompressionContext(&t_lz4.dctx, LZ4F_VERSION));
+                LZ4F_resetDecompressionContext(t_lz4.dctx);
+
+                LZ4F_frameInfo_t info;
+                memset(&info, 0, sizeof(info));
+                auto headerLen = src.size();
+                checkLz4(LZ4F_getFrameInfo(t_lz4.dctx, &info, src.data(), &headerLen));
+                // the size comes from the frame header, it must not allocate more than the data can hold
+                if (info.contentSize / MaxLz4Ratio > src.size())
+                    throw std::runtime_error("Invalid LZ4 data");
+
+                std::vector<uint8_t> out(info.contentSize ? info.contentSize : src.size() * 4);
+                size_t inPos = headerLen, outPos = 0;
+                while (true) {
+                    auto inLen = src.size() - inPos;
+                    auto outLen = out.size() - outPos;
+                    auto ret = LZ4F_decompress(t_lz4.dctx, out.data() + outPos, &outLen, src.data() + inPos, &inLen, nullptr);
+                    checkLz4(ret);
+                    inPos += inLen;
+                    outPos += outLen;
+                    if (ret == 0)
+                        break;
+                    if (inPos == src.size() && outPos < out.size())
+                        throw std::runtime_error("Unexpected end of LZ4 data");
+                    if (outPos == out.size())
+                        out.resize(out.size() * 2);
+                }
+                out.resize(outPos);
+                return out;
+            }
+        };
+    } // namespace
+
+    std::shared_ptr<CompressionBackend> lz4Backend() {
+        static auto backend = std::make_shared<Lz4Backend>();
+        return backend;
+    }
+#endif
+} // namespace nbt
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <bit>
+#include <type_traits>
+
+#include "ByteSwap.hpp"
+
+namespace nbt {
+    // How numbers and lengths are laid out on the wire. The tag structure is the same in all of them.
+    enum class Encoding : uint8_t {
+        Java,    // big-endian, what Java Edition files use
+        Bedrock, // little-endian, Bedrock Edition files (level.dat after its 8 byte header, the leveldb values)
+        Network  // little-endian with varints: zigzag Int and Long values and lengths, unsigned string lengths
+    };
+
+    // calls f with the encoding as a std::integral_constant, to pick the reader or writer at runtime
+    template <typename F>
+    inline decltype(auto) visitEncoding(Encoding encoding, F&& f) {
+        switch (encoding) {
+        case Encoding::Bedrock:
+            return f(std::integral_constant<Encoding, Encoding::Bedrock>());
+        case Encoding::Network:
+            return f(std::integral_constant<Encoding, Encoding::Network>());
+        default:
+            return f(std::integral_constant<Encoding, Encoding::Java>());
+        }
+    }
+
+    // byte order of the fixed-width values
+    constexpr std::endian byteOrder(Encoding encoding) {
+        return encoding == Encoding::Java ? std::endian::big : std::endian::little;
+    }
+
+    // Whether a value of type T is written as a varint. Every 4 and 8 byte integer (Int, Long and the list and
+    // array lengths) is a zigzag varint, uint16_t is only used for string lengths which are plain unsigned varints.
+    template <Encoding E, typename T>
+    constexpr bool isVarint = E == Encoding::Network && std::is_integral_v<T> && (sizeof(T) >= 4 || std::is_same_v<T, uint16_t>);
+
+    // fewest bytes a value of type T can take
+    template <Encoding E, typename T>
+    constexpr size_t minEncodedSize() {
+        return isVarint<E, T> ? 1 : sizeof(T);
+    }
+
+    // most bytes a varint of type T can take
+    template <typename T>
+    constexpr size_t maxVarintSize() {
+        return sizeof(T) > 4 ? 10 : 5;
+    }
+
+    // converts a fixed-width value between the encoding's byte order and native order, a no-op when they match
+    template <Encoding E, typename T>
+    inline T convertOrder(T val) {
+        if constexpr (byteOrder(E) == std::endian::native)
+            return val;
+        else
+            return swapBytes(val);
+    }
+
+    // the same for a whole array, in place
+    template <Encoding E, typename T>
+    inline void convertOrderArray(T* data, size_t count) {
+        if constexpr (sizeof(T) > 1 && byteOrder(E) != std::endian::native)
+            swapBytesInPlace(data, count, sizeof(T));
+    }
+
+    // the bits of a varint of type T, zigzag-decoded unless it is a string length
+    template <typename T>
+    inline T fromVarint(uint64_t raw) {
+        if constexpr (sizeof(T) == 2) {
+            return static_cast<T>(raw);
+        } else {
+            using U = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+            auto bits = static_cast<U>(raw);
+            return static_cast<T>((bits >> 1) ^ (~(bits & 1) + 1));
+        }
+    }
+
+    // writes a value of type T as a varint into out (at least maxVarintSize<T>() long), returns the size
+    template <typename T>
+    inline size_t toVarint(T val, uint8_t* out) {
+        uint64_t raw;
+        if constexpr (sizeof(T) == 2) {
+            raw = static_cast<uint16_t>(val);
+        } else {
+            using S = std::conditional_t<sizeof(T) == 4, int32_t, int64_t>;
+            using U = std::make_unsigned_t<S>;
+            auto s = static_cast<S>(val);
+            raw = static_cast<U>((static_cast<U>(s) << 1) ^ static_cast<U>(s >> (sizeof(S) * 8 - 1)));
+        }
+
+        size_t len = 0;
+        while (raw >= 0x80) {
+            out[len++] = static_cast<uint8_t>(raw | 0x80);
+            raw >>= 7;
+        }
+        out[len++] = static_cast<uint8_t>(raw);
+        return len;
+    }
+} // namespace nbt
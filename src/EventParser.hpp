@@ -0,0 +1,202 @@
+#pragma once
+#include <string_view>
+#include <span>
+#include <bit>
+#include <cstring>
+
+#include "Tags.hpp"
+
+namespace nbt {
+    // returned from the begin/key callbacks, Skip jumps over the value without decoding it
+    enum class Visit {
+        Continue,
+        Skip
+    };
+
+    // No-op implementations of every callback, derive from it and hide the ones you need. Strings, keys and chunks
+    // passed to the callbacks are only valid during the call.
+    // Note that declaring one `scalar` overload hides the others, add `using BaseVisitor::scalar;` to keep them.
+    struct BaseVisitor {
+        inline Visit beginCompound() { return Visit::Continue; }
+        inline void endCompound() {}
+        inline Visit beginList(TagID itemsID, size_t length) { return Visit::Continue; }
+        inline void endList() {}
+        // called before every compound entry
+        inline Visit key(std::string_view key, TagID id) { return Visit::Continue; }
+        // char, short, int, long long, float or double
+        template <typename T>
+        inline void scalar(T value) {}
+        inline void string(std::string_view value) {}
+        inline Visit beginArray(TagID id, size_t length) { return Visit::Continue; }
+        // char, int or long long, already in native byte order; an array may be split in several chunks
+        template <typename T>
+        inline void arrayChunk(std::span<const T> values) {}
+        inline void endArray() {}
+    };
+
+    // Push parser walking binary NBT and calling the visitor for every event. The visitor is a template
+    // parameter so the calls are resolved (and usually inlined) at compile time, and so is the encoding of the reader.
+    template <typename Visitor>
+    class EventParser {
+      public:
+        EventParser(Visitor& visitor) : m_visitor(visitor) {}
+
+        // parses a whole NBT document starting with the root compound tag
+        void parse(std::span<uint8_t> bytes) {
+            auto reader = StreamReader(bytes);
+            parse(reader);
+        }
+
+        // same, but the reader may be a streaming one
+        template <Encoding E>
+        void parse(BasicStreamReader<E>& reader) {
+            if (checkedRead<TagID>(reader) != TagID::Compound)
+                throw std::runtime_error("Root tag is not a compound");
+            checkedSkip(reader, checkedRead<uint16_t>(reader));
+            m_depth = 0;
+            parsePayload(reader, TagID::Compound);
+        }
+
+        // parses the payload of a single tag, the reader is left right after it
+        template <Encoding E>
+        void parsePayload(BasicStreamReader<E>& reader, TagID id) {
+            switch (id) {
+            case TagID::Byte: {
+                m_visitor.scalar(checkedRead<char>(reader));
+            } break;
+            case TagID::Short: {
+                m_visitor.scalar(checkedRead<short>(reader));
+            } break;
+            case TagID::Int: {
+                m_visitor.scalar(checkedRead<int>(reader));
+            } break;
+            case TagID::Long: {
+                m_visitor.scalar(checkedRead<long long>(reader));
+            } break;
+            case TagID::Float: {
+                m_visitor.scalar(checkedRead<float>(reader));
+            } break;
+            case TagID::Double: {
+                m_visitor.scalar(checkedRead<double>(reader));
+            } break;
+            case TagID::String: {
+                auto len = checkedRead<uint16_t>(reader);
+                ensureAvailable(reader, len);
+                m_visitor.string({(const char*)reader.remaining().data(), len});
+                reader.skip(len);
+            } break;
+            case TagID::ByteArray: {
+                parseArray<char>(reader, id);
+            } break;
+            case TagID::IntArray: {
+                parseArray<int>(reader, id);
+            } break;
+            case TagID::LongArray: {
+                parseArray<long long>(reader, id);
+            } break;
+            case TagID::List: {
+                auto itemsID = checkedRead<TagID>(reader);
+                auto len = checkedRead<uint32_t>(reader);
+                checkDepth();
+                if (m_visitor.beginList(itemsID, len) == Visit::Skip) {
+                    skipListItems(reader, itemsID, len, m_depth + 1);
+                    return;
+                }
+                m_depth++;
+                for (auto i = 0u; i < len; i++)
+                    parsePayload(reader, itemsID);
+                m_depth--;
+                m_visitor.endList();
+            } break;
+            case TagID::Compound: {
+                checkDepth();
+                if (m_visitor.beginCompound() == Visit::Skip) {
+                    skipPayload(reader, id, m_depth);
+                    return;
+                }
+                m_depth++;
+                while (true) {
+                    auto tag = checkedRead<TagID>(reader);
+                    if (tag == TagID::End)
+                        break;
+
+                    auto len = checkedRead<uint16_t>(reader);
+                    ensureAvailable(reader, len);
+                    auto key = std::string_view((const char*)reader.remaining().data(), len);
+                    reader.skip(len);
+
+                    if (m_visitor.key(key, tag) == Visit::Skip)
+                        skipPayload(reader, tag, m_depth);
+                    else
+                        parsePayload(reader, tag);
+                }
+                m_depth--;
+                m_visitor.endCompound();
+            } break;
+            default: {
+                throw std::runtime_error(std::format("Invalid tag {} while parsing", static_cast<int>(id)));
+            } break;
+            }
+        }
+
+      private:
+        // every level of nesting is a recursive call, hostile input must not run out of stack
+        inline void checkDepth() const {
+            if (m_depth >= MaxDepth)
+                throw std::runtime_error(std::format("Nesting deeper than {}", MaxDepth));
+        }
+
+        template <typename T, Encoding E>
+        void parseArray(BasicStreamReader<E>& reader, TagID id) {
+            auto len = checkedRead<uint32_t>(reader);
+            if (!reader.isStreaming())
+                ensureAvailable(reader, size_t(len) * minEncodedSize<E, T>());
+            if (m_visitor.beginArray(id, len) == Visit::Skip) {
+                skipListItems(reader, scalarTagID<T>(), len);
+                return;
+            }
+
+            if constexpr (sizeof(T) == 1) {
+                // bytes are handed out straight from the buffer, a streaming reader gives one chunk per window
+                for (size_t done = 0; done < len;) {
+                    ensureAvailable(reader, 1);
+                    auto count = std::min<size_t>(reader.len(), len - done);
+                    m_visitor.arrayChunk(std::span<const T>{(const T*)reader.remaining().data(), count});
+                    reader.skip(count);
+                    done += count;
+                }
+            } else {
+                constexpr size_t chunkSize = 512;
+                T chunk[chunkSize];
+                for (size_t done = 0; done < len;) {
+                    auto count = std::min<size_t>(chunkSize, len - done);
+                    if (!reader.readArray(std::span<T>(chunk, count)))
+                        throw std::runtime_error("Unexpected end of data");
+                    m_visitor.arrayChunk(std::span<const T>{chunk, count});
+                    done += count;
+                }
+            }
+            m_visitor.endArray();
+        }
+
+        Visitor& m_visitor;
+        // containers entered around the payload being parsed
+        size_t m_depth = 0;
+    };
+
+    template <typename Visitor>
+    void parseEvents(std::span<uint8_t> bytes, Visitor& visitor, Encoding encoding = Encoding::Java) {
+        visitEncoding(encoding, [&](auto e) {
+            auto reader = BasicStreamReader<e.value>(bytes);
+            EventParser<Visitor>(visitor).parse(reader);
+        });
+    }
+
+    template <typename Visitor>
+    void parseEvents(StreamSource& source, Visitor& visitor, Encoding encoding = Encoding::Java) {
+        visitEncoding(encoding, [&](auto e) {
+            auto reader = BasicStreamReader<e.value>(source);
+            EventParser<Visitor>(visitor).parse(reader);
+        });
+    }
+} // namespace nbt
@@ -0,0 +1,105 @@
+#include "InflateSource.hpp"
+
+#include <format>
+#include <stdexcept>
+#ifdef nbtpp_zlib
+#include <zlib.h>
+#endif
+
+namespace nbt {
+#ifdef nbtpp_zlib
+    struct InflateSource::State {
+        z_stream strm {};
+    };
+
+    InflateSource::InflateSource(const std::string& path, size_t inputChunk, size_t windowSize)
+        : StreamSource(windowSize), m_file(path, std::ios::binary), m_input(inputChunk) {
+        if (!m_file)
+            throw std::runtime_error(std::format("Failed to open file \"{}\"", path));
+        init();
+    }
+
+    InflateSource::InflateSource(std::span<const uint8_t> compressed, size_t windowSize) : StreamSource(windowSize) {
+        init();
+        m_state->strm.next_in = (Bytef*)compressed.data();
+        m_state->strm.avail_in = compressed.size();
+    }
+
+    void InflateSource::init() {
+        m_state = std::make_unique<State>();
+        // 32 + MAX_WBITS: detect gzip or zlib from the header
+        if (inflateInit2(&m_state->strm, 32 + MAX_WBITS) != Z_OK)
+            throw std::runtime_error("Failed to create a zlib stream");
+    }
+
+    InflateSource::~InflateSource() {
+        if (m_state)
+            inflateEnd(&m_state->strm);
+    }
+
+    size_t InflateSource::produce(std::span<uint8_t> dst) {
+        auto& strm = m_state->strm;
+        strm.next_out = (Bytef*)dst.data();
+        strm.avail_out = dst.size();
+
+        while (!m_done && strm.avail_out) {
+            if (!strm.avail_in && m_file.is_open()) {
+                m_file.read((char*)m_input.data(), m_input.size());
+                strm.next_in = (Bytef*)m_input.data();
+                strm.avail_in = m_file.gcount();
+            }
+
+            auto availIn = strm.avail_in;
+            auto availOut = strm.avail_out;
+            auto code = inflate(&strm, Z_NO_FLUSH);
+            if (code == Z_STREAM_END) {
+                m_done = true;
+            } else if (code == Z_BUF_ERROR && !strm.avail_in) {
+                throw std::runtime_error("Unexpected end of compressed data");
+            } else if (code != Z_OK && code != Z_BUF_ERROR) {
+                throw std::runtime_error(std::format("Zlib error while decompressing (code {})", code));
+            } else if (availIn == strm.avail_in && availOut == strm.avail_out) {
+                throw std::runtime_error("Zlib made no progress while decompressing");
+            }
+        }
+
+        return dst.size() - strm.avail_out;
+    }
+
+    void InflateSource::reset(std::span<const uint8_t> compressed) {
+        if (inflateReset(&m_state->strm) != Z_OK)
+            throw std::runtime_error("Failed to reset a zlib stream");
+        if (m_file.is_open())
+            m_file.close();
+        m_state->strm.next_in = (Bytef*)compressed.data();
+        m_state->strm.avail_in = compressed.size();
+        m_done = false;
+    }
+
+    size_t InflateSource::totalOut() const {
+        return m_state->strm.total_out;
+    }
+#else
+    struct InflateSource::State {};
+
+    InflateSource::InflateSource(const std::string& path, size_t inputChunk, size_t windowSize) {
+        throw std::runtime_error("Compile nbtpp with zlib!");
+    }
+
+    InflateSource::InflateSource(std::span<const uint8_t> compressed, size_t windowSize) {
+        throw std::runtime_error("Compile nbtpp with zlib!");
+    }
+
+    InflateSource::~InflateSource() {}
+
+    size_t InflateSource::produce(std::span<uint8_t> dst) {
+        return 0;
+    }
+
+    void InflateSource::reset(std::span<const uint8_t> compressed) {}
+
+    size_t InflateSource::totalOut() const {
+        return 0;
+    }
+#endif
+} // namespace nbt
@@ -0,0 +1,36 @@
+#pragma once
+#include <string>
+#include <fstream>
+#include <vector>
+#include <span>
+#include <memory>
+
+#include "StreamSource.hpp"
+
+namespace nbt {
+    // Inflates gzip or zlib data (detected from the header) through fixed-size buffers, either from a file read in
+    // chunks or from memory. Peak memory is the input chunk + the reader window no matter how big the data is.
+    class InflateSource : public StreamSource {
+      public:
+        InflateSource(const std::string& path, size_t inputChunk = 64 * 1024, size_t windowSize = 128 * 1024);
+        InflateSource(std::span<const uint8_t> compressed, size_t windowSize = 128 * 1024);
+        ~InflateSource() override;
+
+        size_t produce(std::span<uint8_t> dst) override;
+
+        // starts over on another compressed buffer, reusing the zlib state and the window
+        void reset(std::span<const uint8_t> compressed);
+
+        // total amount of bytes inflated so far
+        size_t totalOut() const;
+
+      private:
+        void init();
+
+        struct State;
+        std::unique_ptr<State> m_state;
+        std::ifstream m_file;
+        std::vector<uint8_t> m_input;
+        bool m_done = false;
+    };
+} // namespace nbt
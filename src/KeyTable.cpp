@@ -0,0 +1,237 @@
+#include "KeyTable.hpp"
+#include "nbtpp.hpp"
+
+#include <cstring>
+#include <mutex>
+#include <functional>
+
+namespace nbt {
+    // keys of vanilla chunks, block states, entities, items, block entities, players and level.dat
+    static constexpr std::string_view builtinKeys[] = {
+        // chunks
+        "Level", "DataVersion", "xPos", "yPos", "zPos", "LastUpdate", "InhabitedTime", "Status", "isLightOn", "Sections",
+        "sections", "Y", "BlockStates", "block_states", "Palette", "palette", "data", "biomes", "BlockLight", "SkyLight",
+        "Biomes", "Heightmaps", "MOTION_BLOCKING", "MOTION_BLOCKING_NO_LEAVES", "OCEAN_FLOOR", "OCEAN_FLOOR_WG",
+        "WORLD_SURFACE", "WORLD_SURFACE_WG", "Entities", "TileEntities", "block_entities", "TileTicks", "LiquidTicks",
+        "block_ticks", "fluid_ticks", "PostProcessing", "ToBeTicked", "LiquidsToBeTicked", "Lights", "CarvingMasks",
+        "structures", "Structures", "References", "Starts", "starts", "references", "blending_data",
+        "min_section", "max_section", "i", "p", "t", "x", "y", "z", "keepPacked",
+        // block states
+        "Name", "Properties", "facing", "half", "axis", "type", "age", "level", "lit", "open", "powered", "snowy", "shape",
+        "north", "south", "east", "west", "up", "down", "distance", "persistent", "waterlogged", "part", "occupied",
+        "rotation", "power", "hinge", "in_wall", "attached", "face", "stage", "moisture", "layers", "bites", "charges",
+        "hanging", "variant", "mode", "short", "extended", "delay", "locked", "triggered", "conditional", "enabled",
+        // entities
+        "id", "UUID", "Pos", "Motion", "Rotation", "Air", "FallDistance", "Fire", "Invulnerable", "OnGround",
+        "PortalCooldown", "CustomName", "CustomNameVisible", "Silent", "NoGravity", "Glowing", "Tags", "Passengers",
+        "Health", "AbsorptionAmount", "DeathTime", "HurtTime", "HurtByTimestamp", "FallFlying", "Attributes", "Base",
+        "Modifiers", "Amount", "Operation", "ActiveEffects", "active_effects", "Amplifier", "Duration", "Ambient",
+        "ShowParticles", "ShowIcon", "Brain", "memories", "ArmorItems", "HandItems", "ArmorDropChances",
+        "HandDropChances", "CanPickUpLoot", "PersistenceRequired", "LeftHanded", "Leash", "Age", "ForcedAge", "InLove",
+        "Owner", "Sitting", "CollarColor", "Variant", "Color", "Sheared", "Saddle", "PickupDelay", "Thrower", "Item",
+        "Fuse", "ExplosionRadius", "TileX", "TileY", "TileZ", "Facing", "ItemRotation", "ItemDropChance", "Invisible",
+        "Fixed", "Marker", "ShowArms", "Small", "NoBasePlate", "Pose", "Head", "Body", "LeftArm", "RightArm", "LeftLeg",
+        "RightLeg", "DisabledSlots", "CanBreakDoors", "DrownedConversionTime", "InWaterTime", "IsBaby", "Paper",
+        "HomePosX", "HomePosY", "HomePosZ", "Offers", "Recipes", "VillagerData", "profession", "Xp", "Gossips",
+        "FoodLevel", "LastRestock", "RestocksToday", "Willing",
+        // items
+        "Count", "count", "Slot", "tag", "components", "Damage", "Enchantments", "lvl", "display", "Lore",
+        "CustomModelData", "Unbreakable", "BlockEntityTag", "EntityTag", "Potion", "CustomPotionEffects", "RepairCost",
+        "StoredEnchantments", "HideFlags", "SkullOwner", "Items", "Fireworks", "Explosions", "Flight",
+        // block entities
+        "Text1", "Text2", "Text3", "Text4", "front_text", "back_text", "messages", "color", "has_glowing_text",
+        "is_waxed", "Lock", "LootTable", "LootTableSeed", "CookTime", "CookTimeTotal", "BurnTime", "RecipesUsed",
+        "Levels", "Primary", "Secondary", "Bees", "Delay", "SpawnData", "SpawnCount", "SpawnRange", "MinSpawnDelay",
+        "MaxSpawnDelay", "MaxNearbyEntities", "RequiredPlayerRange", "SpawnPotentials", "Weight", "entity", "weight",
+        "Patterns", "Pattern", "Book", "Page", "Command", "SuccessCount", "auto", "TrackOutput",
+        "UpdateLastExecution", "LastExecution",
+        // players
+        "Inventory", "EnderItems", "SelectedItemSlot", "Dimension", "playerGameType", "previousPlayerGameType",
+        "Score", "XpLevel", "XpP", "XpTotal", "XpSeed", "foodLevel", "foodSaturationLevel", "foodExhaustionLevel",
+        "foodTickTimer", "abilities", "flying", "flySpeed", "walkSpeed", "instabuild", "invulnerable", "mayBuild",
+        "mayfly", "recipeBook", "recipes", "toBeDisplayed", "SpawnX", "SpawnY", "SpawnZ", "SpawnForced",
+        "SpawnDimension", "SpawnAngle", "SleepTimer", "seenCredits", "warden_spawn_tracker", "RootVehicle", "Attach",
+        "Entity",
+        // level.dat
+        "Data", "LevelName", "GameType", "Difficulty", "DifficultyLocked", "DayTime", "Time", "RandomSeed",
+        "WorldGenSettings", "GameRules", "Player", "Version", "Snapshot", "Series", "raining", "rainTime", "thundering",
+        "thunderTime", "clearWeatherTime", "hardcore", "initialized", "allowCommands", "generatorName",
+        "generatorVersion", "generatorOptions", "MapFeatures", "BorderCenterX", "BorderCenterZ", "BorderSize",
+        "BorderSafeZone", "BorderWarningBlocks", "BorderWarningTime", "BorderSizeLerpTarget", "BorderSizeLerpTime",
+        "BorderDamagePerBlock", "WanderingTraderSpawnChance", "WanderingTraderSpawnDelay", "WanderingTraderId",
+        "DragonFight", "CustomBossEvents", "ScheduledEvents", "ServerBrands", "WasModded", "DataPacks", "Enabled",
+        "Disabled", "dimensions", "generator", "settings", "biome_source", "seed", "bonus_chest", "generate_features",
+        "LastPlayed", "version"};
+
+    size_t hashKey(std::string_view key) {
+        return std::hash<std::string_view> {}(key);
+    }
+
+    KeyTable::KeyTable(std::pmr::memory_resource* resource, bool threadSafe)
+        : m_resource(resource), m_builtin(&builtin()), m_threadSafe(threadSafe) {
+        if (!m_resource) {
+            m_ownArena = std::make_unique<std::pmr::monotonic_buffer_resource>();
+            m_resource = m_ownArena.get();
+        }
+    }
+
+    KeyTable::KeyTable(SharedTag) : KeyTable(nullptr, true) {
+        m_maxBytes = SharedTableBytes;
+    }
+
+    KeyTable::KeyTable(BuiltinTag) : m_builtin(nullptr), m_threadSafe(false) {
+        m_ownArena = std::make_unique<std::pmr::monotonic_buffer_resource>();
+        m_resource = m_ownArena.get();
+        for (auto key : builtinKeys)
+            intern(key);
+    }
+
+    Key KeyTable::intern(std::string_view key) {
+        return intern(key, hashKey(key));
+    }
+
+    Key KeyTable::intern(std::string_view key, size_t hash) {
+        if (m_builtin) {
+            if (auto entry = m_builtin->find(key, hash))
+                return Key(entry);
+        }
+
+        if (!m_threadSafe) {
+            if (auto entry = find(key, hash))
+                return Key(entry);
+            return Key(insert(key, hash));
+        }
+
+        {
+            std::shared_lock lock(m_mutex);
+            if (auto entry = find(key, hash))
+                return Key(entry);
+        }
+
+        // another thread may have added it in between
+        std::unique_lock lock(m_mutex);
+        if (auto entry = find(key, hash))
+            return Key(entry);
+        return Key(insert(key, hash));
+    }
+
+    std::optional<Key> KeyTable::tryIntern(std::string_view key, size_t hash) {
+        if (m_maxBytes == SIZE_MAX)
+            return intern(key, hash);
+        if (m_builtin) {
+            if (auto entry = m_builtin->find(key, hash))
+                return Key(entry);
+        }
+
+        if (!m_threadSafe) {
+            if (auto entry = find(key, hash))
+                return Key(entry);
+            return isFull(key) ? std::nullopt : std::optional(Key(insert(key, hash)));
+        }
+
+        {
+            // once the table is full, new keys don't need the exclusive lock
+            std::shared_lock lock(m_mutex);
+            if (auto entry = find(key, hash))
+                return Key(entry);
+            if (isFull(key))
+                return std::nullopt;
+        }
+
+        std::unique_lock lock(m_mutex);
+        if (auto entry = find(key, hash))
+            return Key(entry);
+        return isFull(key) ? std::nullopt : std::optional(Key(insert(key, hash)));
+    }
+
+    bool KeyTable::owns(Key key) const {
+        if (key.isOwned())
+            return false;
+        if (!m_threadSafe)
+            return find(key.view(), key.hash()) == key.m_entry;
+        std::shared_lock lock(m_mutex);
+        return find(key.view(), key.hash()) == key.m_entry;
+    }
+
+    Key KeyTable::makeOwned(std::string_view key, size_t hash, std::pmr::memory_resource* resource) {
+        auto entry = new (resource->allocate(entryBytes(key), alignof(KeyEntry))) KeyEntry {hash, uint16_t(key.size()), true};
+        memcpy((char*)entry->data(), key.data(), key.size());
+        ((char*)entry->data())[key.size()] = '\0';
+        return Key(entry);
+    }
+
+    void KeyTable::releaseOwned(Key key, std::pmr::memory_resource* resource) {
+        if (key.isOwned())
+            resource->deallocate((void*)key.m_entry, entryBytes(key), alignof(KeyEntry));
+    }
+
+    const KeyEntry* KeyTable::find(std::string_view key, size_t hash) const {
+        if (m_slots.empty())
+            return nullptr;
+
+        auto mask = m_slots.size() - 1;
+        for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+            auto entry = m_slots[slot];
+            if (!entry)
+                return nullptr;
+            if (entry->hash == hash && entry->size == key.size() && memcmp(entry->data(), key.data(), key.size()) == 0)
+                return entry;
+        }
+    }
+
+    const KeyEntry* KeyTable::insert(std::string_view key, size_t hash) {
+        // keep the table at most half full
+        if ((m_size + 1) * 2 > m_slots.size()) {
+            std::vector<const KeyEntry*> slots(std::max<size_t>(m_slots.size() * 2, 256), nullptr);
+            auto mask = slots.size() - 1;
+            for (auto entry : m_slots) {
+                if (!entry)
+                    continue;
+                auto slot = entry->hash & mask;
+                while (slots[slot])
+                    slot = (slot + 1) & mask;
+                slots[slot] = entry;
+            }
+            m_slots = std::move(slots);
+        }
+
+        auto bytes = entryBytes(key);
+        auto entry = new (m_resource->allocate(bytes, alignof(KeyEntry))) KeyEntry {hash, uint16_t(key.size())};
+        memcpy((char*)entry->data(), key.data(), key.size());
+        ((char*)entry->data())[key.size()] = '\0';
+
+        auto mask = m_slots.size() - 1;
+        auto slot = hash & mask;
+        while (m_slots[slot])
+            slot = (slot + 1) & mask;
+        m_slots[slot] = entry;
+
+        m_size++;
+        m_bytes += bytes;
+        return entry;
+    }
+
+    void KeyTable::clear() {
+        std::fill(m_slots.begin(), m_slots.end(), nullptr);
+        m_size = 0;
+        m_bytes = 0;
+    }
+
+    KeyTable& KeyTable::shared() {
+        static KeyTable table {SharedTag {}};
+        return table;
+    }
+
+    const KeyTable& KeyTable::builtin() {
+        static const KeyTable table {BuiltinTag {}};
+        return table;
+    }
+
+    KeyTable& keyTableFor(std::pmr::memory_resource* resource) {
+        if (resource == heapResource())
+            return KeyTable::shared();
+        if (auto arena = dynamic_cast<KeyArena*>(resource))
+            return arena->keys();
+        return KeyTable::shared();
+    }
+} // namespace nbt
@@ -0,0 +1,137 @@
+#pragma once
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <shared_mutex>
+#include <format>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+
+#include "Stats.hpp"
+
+namespace nbt {
+    // an interned key: its hash and length followed by the characters
+    struct KeyEntry {
+        size_t hash;
+        uint16_t size;
+        // not in a table but owned by the compound holding it, see KeyTable::shared
+        bool owned = false;
+
+        inline const char* data() const { return reinterpret_cast<const char*>(this + 1); }
+    };
+
+    // Pointer-sized handle to a key interned in a KeyTable. Keys from the same table are equal exactly when the
+    // pointers are, keys from different tables fall back to comparing the (stored) hash and then the characters.
+    class Key {
+      public:
+        inline std::string_view view() const { return {m_entry->data(), m_entry->size}; }
+        inline operator std::string_view() const { return view(); }
+        inline const char* data() const { return m_entry->data(); }
+        inline size_t size() const { return m_entry->size; }
+        inline size_t hash() const { return m_entry->hash; }
+        inline bool isOwned() const { return m_entry->owned; }
+
+        inline bool operator==(const Key& other) const {
+            return m_entry == other.m_entry || (m_entry->hash == other.m_entry->hash && view() == other.view());
+        }
+        inline bool operator==(std::string_view other) const { return view() == other; }
+
+      private:
+        friend class KeyTable;
+        explicit Key(const KeyEntry* entry) : m_entry(entry) {}
+
+        const KeyEntry* m_entry;
+    };
+
+    size_t hashKey(std::string_view key);
+
+    // Interns compound keys so every distinct key is stored once. Lookups first go to a built-in table of the keys
+    // used by vanilla chunks, entities, players and level.dat, which is never modified and needs no locking.
+    class KeyTable {
+      public:
+        // keys are allocated on `resource`, a null resource means the table owns a heap arena
+        KeyTable(std::pmr::memory_resource* resource = nullptr, bool threadSafe = false);
+        KeyTable(const KeyTable&) = delete;
+        KeyTable& operator=(const KeyTable&) = delete;
+
+        Key intern(std::string_view key);
+        Key intern(std::string_view key, size_t hash);
+        // like intern, but returns nothing rather than grow the table beyond its limit
+        std::optional<Key> tryIntern(std::string_view key, size_t hash);
+        // whether `key` was interned in this table itself (not in the built-in one it falls back to)
+        bool owns(Key key) const;
+
+        // keys added on top of the built-in ones and the bytes they take
+        inline size_t size() const { return m_size; }
+        inline size_t bytes() const { return m_bytes; }
+
+        // forgets every key, only valid while releasing the resource they were allocated on
+        void clear();
+
+        // Thread-safe table used for trees which are not allocated in a Document, its keys are never freed. Compounds
+        // only intern into it up to SharedTableBytes, e.g. a server loading arbitrary keys from its players; past
+        // that their new keys are owned keys, allocated for each compound holding them and freed with it.
+        static KeyTable& shared();
+        static constexpr size_t SharedTableBytes = 4 << 20;
+        // the built-in keys
+        static const KeyTable& builtin();
+
+        // a key outside any table, allocated on `resource`; it has to be freed with releaseOwned
+        static Key makeOwned(std::string_view key, size_t hash, std::pmr::memory_resource* resource);
+        // frees a key from makeOwned, does nothing for an interned key
+        static void releaseOwned(Key key, std::pmr::memory_resource* resource);
+
+      private:
+        struct BuiltinTag {};
+        KeyTable(BuiltinTag);
+        struct SharedTag {};
+        KeyTable(SharedTag);
+
+        const KeyEntry* find(std::string_view key, size_t hash) const;
+        const KeyEntry* insert(std::string_view key, size_t hash);
+        inline bool isFull(std::string_view key) const { return m_bytes + entryBytes(key) > m_maxBytes; }
+        static inline size_t entryBytes(std::string_view key) { return sizeof(KeyEntry) + key.size() + 1; }
+
+        std::unique_ptr<std::pmr::monotonic_buffer_resource> m_ownArena;
+        std::pmr::memory_resource* m_resource;
+        const KeyTable* m_builtin;
+        std::vector<const KeyEntry*> m_slots;
+        size_t m_size = 0;
+        size_t m_bytes = 0;
+        // only tryIntern respects it
+        size_t m_maxBytes = SIZE_MAX;
+        bool m_threadSafe;
+        mutable std::shared_mutex m_mutex;
+    };
+
+    // Arena whose compounds intern their keys into a table living (and dying) with it, this is what Document uses.
+    class KeyArena : public std::pmr::monotonic_buffer_resource {
+      public:
+        KeyArena(size_t initialSize) : std::pmr::monotonic_buffer_resource(initialSize), m_keys(this) {}
+
+        inline KeyTable& keys() { return m_keys; }
+        void release() {
+            m_keys.clear();
+            std::pmr::monotonic_buffer_resource::release();
+        }
+
+      private:
+#ifdef nbtpp_stats
+        void* do_allocate(size_t bytes, size_t align) override {
+            detail::countAllocation(bytes);
+            return std::pmr::monotonic_buffer_resource::do_allocate(bytes, align);
+        }
+#endif
+
+        KeyTable m_keys;
+    };
+
+    // the table compounds allocated on `resource` intern into: the arena's own one or the shared table
+    KeyTable& keyTableFor(std::pmr::memory_resource* resource);
+} // namespace nbt
+
+template <>
+struct std::formatter<nbt::Key> : std::formatter<std::string_view> {
+    auto format(const nbt::Key& key, std::format_context& ctx) const { return std::formatter<std::string_view>::format(key.view(), ctx); }
+};
@@ -0,0 +1,109 @@
+#include "MappedFile.hpp"
+
+#include <format>
+#include <stdexcept>
+#include <utility>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace nbt {
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::string& path, MapAccess access) {
+        DWORD flags = access == MapAccess::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN
+                      : access == MapAccess::Random   ? FILE_FLAG_RANDOM_ACCESS
+                                                      : FILE_ATTRIBUTE_NORMAL;
+        m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE) {
+            m_file = nullptr;
+            throw std::runtime_error(std::format("Failed to open file \"{}\"", path));
+        }
+
+        LARGE_INTEGER size;
+        GetFileSizeEx(m_file, &size);
+        m_size = static_cast<size_t>(size.QuadPart);
+        if (!m_size)
+            return;
+
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping)
+            m_data = (uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!m_data) {
+            unmap();
+            throw std::runtime_error(std::format("Failed to map file \"{}\"", path));
+        }
+    }
+
+    MappedFile::~MappedFile() {
+        unmap();
+    }
+
+    void MappedFile::advise(MapAccess access) {
+        // the caching hint is fixed when the file is opened on windows
+    }
+
+    void MappedFile::unmap() {
+        if (m_data)
+            UnmapViewOfFile(m_data);
+        if (m_mapping)
+            CloseHandle(m_mapping);
+        if (m_file)
+            CloseHandle(m_file);
+        m_data = nullptr;
+        m_mapping = nullptr;
+        m_file = nullptr;
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)),
+          m_file(std::exchange(other.m_file, nullptr)), m_mapping(std::exchange(other.m_mapping, nullptr)) {}
+#else
+    MappedFile::MappedFile(const std::string& path, MapAccess access) {
+        auto fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error(std::format("Failed to open file \"{}\"", path));
+
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error(std::format("Failed to stat file \"{}\"", path));
+        }
+
+        m_size = static_cast<size_t>(st.st_size);
+        if (m_size) {
+            auto data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error(std::format("Failed to map file \"{}\"", path));
+            }
+            m_data = (uint8_t*)data;
+            advise(access);
+        }
+
+        // the mapping stays valid after the descriptor is closed
+        close(fd);
+    }
+
+    MappedFile::~MappedFile() {
+        if (m_data)
+            munmap(m_data, m_size);
+    }
+
+    void MappedFile::advise(MapAccess access) {
+        if (!m_data)
+            return;
+
+        auto advice = access == MapAccess::Sequential ? MADV_SEQUENTIAL : access == MapAccess::Random ? MADV_RANDOM : MADV_NORMAL;
+        madvise(m_data, m_size, advice);
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)) {}
+#endif
+} // namespace nbt
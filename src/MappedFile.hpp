@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace nbt {
+    // how the mapping is going to be read, passed on to the kernel as a readahead hint
+    enum class MapAccess {
+        Normal,
+        Sequential,
+        Random
+    };
+
+    // Read-only memory mapping of a whole file. The bytes are exposed as a mutable span so they can be handed to
+    // StreamReader (and the views, the event parser or an InflateSource) directly, but must never be written to.
+    class MappedFile {
+      public:
+        MappedFile(const std::string& path, MapAccess access = MapAccess::Sequential);
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile();
+
+        inline std::span<uint8_t> bytes() const { return {m_data, m_size}; }
+        inline size_t size() const { return m_size; }
+
+        // changes the readahead hint for the rest of the mapping's life
+        void advise(MapAccess access);
+
+      private:
+#ifdef _WIN32
+        void unmap();
+#endif
+
+        uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+#ifdef _WIN32
+        void* m_file = nullptr;
+        void* m_mapping = nullptr;
+#endif
+    };
+} // namespace nbt
@@ -0,0 +1,198 @@
+#include "NbtView.hpp"
+
+#include <stdexcept>
+
+namespace nbt {
+    template <Encoding E>
+    void BasicNbtView<E>::expect(TagID id) const {
+        if (m_id != id)
+            throw std::runtime_error(std::format("Tag {} can't be viewed as tag {}", static_cast<int>(m_id), static_cast<int>(id)));
+    }
+
+    template <Encoding E>
+    void BasicNbtView<E>::throwTruncated() {
+        throw std::runtime_error("Unexpected end of data");
+    }
+
+    template <Encoding E>
+    std::string_view BasicNbtView<E>::asString() const {
+        expect(TagID::String);
+        auto r = BasicStreamReader<E>(m_data);
+        if (r.len() < minEncodedSize<E, uint16_t>())
+            throwTruncated();
+        auto len = r.template read<uint16_t>();
+        if (r.len() < len)
+            throwTruncated();
+        return {(const char*)r.remaining().data(), len};
+    }
+
+    template <Encoding E>
+    template <typename T>
+    ArrayView<T, E> BasicNbtView<E>::arrayAs(TagID id) const {
+        expect(id);
+        auto r = BasicStreamReader<E>(m_data);
+        if (r.len() < minEncodedSize<E, uint32_t>())
+            throwTruncated();
+        auto len = r.template read<uint32_t>();
+        if (r.len() / minEncodedSize<E, T>() < len)
+            throwTruncated();
+
+        auto data = r.remaining().data();
+        if constexpr (isVarint<E, T>) {
+            // walks the varints once, so the view can decode them without checks
+            for (size_t i = 0; i < len; i++)
+                r.template read<T>();
+            return {data, len, size_t(r.remaining().data() - data)};
+        } else {
+            return {data, len};
+        }
+    }
+
+    template <Encoding E>
+    ArrayView<char, E> BasicNbtView<E>::asByteArray() const {
+        return arrayAs<char>(TagID::ByteArray);
+    }
+
+    template <Encoding E>
+    ArrayView<int, E> BasicNbtView<E>::asIntArray() const {
+        return arrayAs<int>(TagID::IntArray);
+    }
+
+    template <Encoding E>
+    ArrayView<long long, E> BasicNbtView<E>::asLongArray() const {
+        return arrayAs<long long>(TagID::LongArray);
+    }
+
+    template <Encoding E>
+    BasicListView<E> BasicNbtView<E>::asList() const {
+        expect(TagID::List);
+        auto r = BasicStreamReader<E>(m_data);
+        if (r.len() < 1 + minEncodedSize<E, uint32_t>())
+            throwTruncated();
+        auto itemsID = r.template read<TagID>();
+        auto len = r.template read<uint32_t>();
+        return {itemsID, len, r.remaining()};
+    }
+
+    template <Encoding E>
+    BasicCompoundView<E> BasicNbtView<E>::asCompound() const {
+        expect(TagID::Compound);
+        return {m_data};
+    }
+
+    template <Encoding E>
+    size_t BasicNbtView<E>::payloadSize() const {
+        auto r = BasicStreamReader<E>(m_data);
+        skipPayload(r, m_id);
+        return m_data.size() - r.len();
+    }
+
+    template <Encoding E>
+    typename BasicListView<E>::Iterator& BasicListView<E>::Iterator::operator++() {
+        if (--m_left)
+            m_data = m_data.subspan(BasicNbtView<E>(m_itemsID, m_data).payloadSize());
+        return *this;
+    }
+
+    template <Encoding E>
+    BasicNbtView<E> BasicListView<E>::operator[](size_t i) const {
+        if (i >= m_len)
+            throw std::out_of_range(std::format("List index {} is out of range (length {})", i, m_len));
+
+        if (auto size = fixedPayloadSize(m_itemsID, E)) {
+            if (m_data.size() / size <= i)
+                throw std::runtime_error("Unexpected end of data");
+            return {m_itemsID, m_data.subspan(i * size)};
+        }
+
+        auto r = BasicStreamReader<E>(m_data);
+        for (size_t j = 0; j < i; j++)
+            skipPayload(r, m_itemsID);
+        return {m_itemsID, r.remaining()};
+    }
+
+    template <Encoding E>
+    BasicCompoundView<E>::Iterator::Iterator(std::span<uint8_t> data) : m_data(data) {
+        if (m_data.data())
+            readEntry();
+    }
+
+    template <Encoding E>
+    void BasicCompoundView<E>::Iterator::readEntry() {
+        auto r = BasicStreamReader<E>(m_data);
+        if (r.len() < 1)
+            throw std::runtime_error("Unexpected end of data");
+
+        auto tag = r.template read<TagID>();
+        if (tag == TagID::End) {
+            m_data = {};
+            return;
+        }
+
+        if (r.len() < minEncodedSize<E, uint16_t>())
+            throw std::runtime_error("Unexpected end of data");
+        auto len = r.template read<uint16_t>();
+        if (r.len() < len)
+            throw std::runtime_error("Unexpected end of data");
+
+        m_entry.key = {(const char*)r.remaining().data(), len};
+        r.skip(len);
+        m_entry.value = BasicNbtView<E>(tag, r.remaining());
+    }
+
+    template <Encoding E>
+    typename BasicCompoundView<E>::Iterator& BasicCompoundView<E>::Iterator::operator++() {
+        auto payload = m_entry.value.data();
+        m_data = payload.subspan(m_entry.value.payloadSize());
+        readEntry();
+        return *this;
+    }
+
+    template <Encoding E>
+    std::optional<BasicNbtView<E>> BasicCompoundView<E>::find(std::string_view key) const {
+        for (const auto& entry : *this) {
+            if (entry.key == key)
+                return entry.value;
+        }
+        return std::nullopt;
+    }
+
+    template <Encoding E>
+    BasicNbtView<E> BasicCompoundView<E>::at(std::string_view key) const {
+        auto val = find(key);
+        if (!val)
+            throw std::out_of_range(std::format("No key \"{}\" in the compound", key));
+        return *val;
+    }
+
+    template <Encoding E>
+    BasicCompoundView<E> viewFromBytes(std::span<uint8_t> bytes) {
+        if (!bytes.size() || !bytes.data()) {
+            throw std::runtime_error("Invalid input data");
+        }
+
+        auto r = BasicStreamReader<E>(bytes);
+        if (r.template read<TagID>() != TagID::Compound || r.len() < minEncodedSize<E, uint16_t>())
+            throw std::runtime_error("Root tag is not a compound");
+        auto nameLen = r.template read<uint16_t>();
+        if (r.len() < nameLen)
+            throw std::runtime_error("Unexpected end of data");
+        r.skip(nameLen);
+
+        return {r.remaining()};
+    }
+
+    template class BasicNbtView<Encoding::Java>;
+    template class BasicNbtView<Encoding::Bedrock>;
+    template class BasicNbtView<Encoding::Network>;
+    template class BasicListView<Encoding::Java>;
+    template class BasicListView<Encoding::Bedrock>;
+    template class BasicListView<Encoding::Network>;
+    template class BasicCompoundView<Encoding::Java>;
+    template class BasicCompoundView<Encoding::Bedrock>;
+    template class BasicCompoundView<Encoding::Network>;
+
+    template BasicCompoundView<Encoding::Java> viewFromBytes(std::span<uint8_t>);
+    template BasicCompoundView<Encoding::Bedrock> viewFromBytes(std::span<uint8_t>);
+    template BasicCompoundView<Encoding::Network> viewFromBytes(std::span<uint8_t>);
+} // namespace nbt
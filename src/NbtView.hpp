@@ -0,0 +1,204 @@
+#pragma once
+#include <string_view>
+#include <optional>
+#include <span>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+#include "Tags.hpp"
+
+namespace nbt {
+    template <Encoding E>
+    class BasicListView;
+    template <Encoding E>
+    class BasicCompoundView;
+
+    // Read-only array payload living in the source buffer, elements are converted to native order on access. Items
+    // of a varint array (Int and Long arrays in the network encoding) are decoded from the start on every access.
+    template <typename T, Encoding E = Encoding::Java>
+    class ArrayView {
+        static_assert(std::is_same_v<T, char> || std::is_same_v<T, int> || std::is_same_v<T, long long>,
+                      "ArrayView can only accept char, int or long long!");
+
+      public:
+        ArrayView() : m_data(nullptr), m_len(0), m_size(0) {}
+        ArrayView(const uint8_t* data, size_t len) : m_data(data), m_len(len), m_size(len * sizeof(T)) {}
+        // `size` is the size of the items in bytes
+        ArrayView(const uint8_t* data, size_t len, size_t size) : m_data(data), m_len(len), m_size(size) {}
+
+        inline size_t length() const { return m_len; }
+        inline std::span<const uint8_t> bytes() const { return {m_data, m_size}; }
+
+        inline T operator[](size_t i) const {
+            if constexpr (isVarint<E, T>) {
+                auto r = reader();
+                for (; i; i--)
+                    r.template readUnchecked<T>();
+                return r.template readUnchecked<T>();
+            } else {
+                T val;
+                memcpy(&val, m_data + i * sizeof(T), sizeof(T));
+                return convertOrder<E>(val);
+            }
+        }
+
+        std::vector<T> toVector() const {
+            std::vector<T> out(m_len);
+            if constexpr (isVarint<E, T>) {
+                auto r = reader();
+                r.readArrayUnchecked(std::span<T>(out));
+            } else {
+                if (m_len)
+                    memcpy(out.data(), m_data, m_len * sizeof(T));
+                convertOrderArray<E>(out.data(), m_len);
+            }
+            return out;
+        }
+
+      private:
+        // the varints were all checked when the view was created
+        inline BasicStreamReader<E> reader() const { return BasicStreamReader<E>({const_cast<uint8_t*>(m_data), m_size}); }
+
+        const uint8_t* m_data;
+        size_t m_len;
+        size_t m_size;
+    };
+
+    // A single tag in the source buffer. Nothing is decoded until one of the accessors is called and
+    // the view (and everything obtained from it) is only valid as long as the buffer is.
+    template <Encoding E = Encoding::Java>
+    class BasicNbtView {
+      public:
+        BasicNbtView() : m_id(TagID::None) {}
+        BasicNbtView(TagID id, std::span<uint8_t> data) : m_id(id), m_data(data) {}
+
+        inline TagID getID() const { return m_id; }
+        // the payload of this tag followed by the rest of the buffer
+        inline std::span<uint8_t> data() const { return m_data; }
+
+        // scalars: char, short, int, long long, float or double, has to match the tag exactly
+        template <typename T>
+        T as() const {
+            constexpr auto id = scalarTagID<T>();
+            static_assert(id != TagID::None, "NbtView::as can only read scalar types");
+            expect(id);
+            if (m_data.size() < minEncodedSize<E, T>())
+                throwTruncated();
+            return BasicStreamReader<E>(m_data).template read<T>();
+        }
+
+        std::string_view asString() const;
+        ArrayView<char, E> asByteArray() const;
+        ArrayView<int, E> asIntArray() const;
+        ArrayView<long long, E> asLongArray() const;
+        BasicListView<E> asList() const;
+        BasicCompoundView<E> asCompound() const;
+
+        // number of bytes taken by the payload, walks nested containers
+        size_t payloadSize() const;
+
+      private:
+        void expect(TagID id) const;
+        [[noreturn]] static void throwTruncated();
+        template <typename T>
+        ArrayView<T, E> arrayAs(TagID id) const;
+
+        TagID m_id;
+        std::span<uint8_t> m_data;
+    };
+
+    template <Encoding E = Encoding::Java>
+    class BasicListView {
+      public:
+        class Iterator {
+          public:
+            Iterator(TagID itemsID, std::span<uint8_t> data, size_t left) : m_itemsID(itemsID), m_data(data), m_left(left) {}
+
+            inline BasicNbtView<E> operator*() const { return BasicNbtView<E>(m_itemsID, m_data); }
+            Iterator& operator++();
+            inline bool operator==(const Iterator& other) const { return m_left == other.m_left; }
+
+          private:
+            TagID m_itemsID;
+            std::span<uint8_t> m_data;
+            size_t m_left;
+        };
+
+        BasicListView() : m_itemsID(TagID::End), m_len(0) {}
+        BasicListView(TagID itemsID, size_t len, std::span<uint8_t> data) : m_itemsID(itemsID), m_len(len), m_data(data) {}
+
+        inline TagID getItemsID() const { return m_itemsID; }
+        inline size_t length() const { return m_len; }
+
+        // O(1) for lists of fixed-size tags, otherwise the preceding items are skipped over
+        BasicNbtView<E> operator[](size_t i) const;
+
+        inline Iterator begin() const { return Iterator(m_itemsID, m_data, m_len); }
+        inline Iterator end() const { return Iterator(m_itemsID, {}, 0); }
+
+      private:
+        TagID m_itemsID;
+        size_t m_len;
+        std::span<uint8_t> m_data;
+    };
+
+    template <Encoding E = Encoding::Java>
+    class BasicCompoundView {
+      public:
+        struct Entry {
+            std::string_view key;
+            BasicNbtView<E> value;
+        };
+
+        class Iterator {
+          public:
+            // an empty span marks the end iterator
+            Iterator(std::span<uint8_t> data);
+
+            inline const Entry& operator*() const { return m_entry; }
+            inline const Entry* operator->() const { return &m_entry; }
+            Iterator& operator++();
+            inline bool operator==(const Iterator& other) const { return m_data.data() == other.m_data.data(); }
+
+          private:
+            void readEntry();
+
+            std::span<uint8_t> m_data;
+            Entry m_entry;
+        };
+
+        BasicCompoundView() {}
+        BasicCompoundView(std::span<uint8_t> data) : m_data(data) {}
+
+        // scans the entries until the key is found, nothing else is decoded
+        std::optional<BasicNbtView<E>> find(std::string_view key) const;
+        inline bool hasKey(std::string_view key) const { return find(key).has_value(); }
+        // same as find but throws if there is no such key
+        BasicNbtView<E> at(std::string_view key) const;
+
+        inline Iterator begin() const { return Iterator(m_data); }
+        inline Iterator end() const { return Iterator({}); }
+
+      private:
+        std::span<uint8_t> m_data;
+    };
+
+    using NbtView = BasicNbtView<Encoding::Java>;
+    using ListView = BasicListView<Encoding::Java>;
+    using CompoundView = BasicCompoundView<Encoding::Java>;
+
+    extern template class BasicNbtView<Encoding::Java>;
+    extern template class BasicNbtView<Encoding::Bedrock>;
+    extern template class BasicNbtView<Encoding::Network>;
+    extern template class BasicListView<Encoding::Java>;
+    extern template class BasicListView<Encoding::Bedrock>;
+    extern template class BasicListView<Encoding::Network>;
+    extern template class BasicCompoundView<Encoding::Java>;
+    extern template class BasicCompoundView<Encoding::Bedrock>;
+    extern template class BasicCompoundView<Encoding::Network>;
+
+    // views the root compound of binary NBT data, no allocations are made
+    template <Encoding E = Encoding::Java>
+    BasicCompoundView<E> viewFromBytes(std::span<uint8_t> bytes);
+} // namespace nbt
@@ -0,0 +1,196 @@
+#include "PathQuery.hpp"
+
+#include <charconv>
+#include <stdexcept>
+#include <format>
+
+#include "nbtpp.hpp"
+
+namespace nbt {
+    PathQuery::PathQuery(std::string_view expr) : m_expr(expr) {
+        auto fail = [&](size_t pos, std::string_view what) {
+            throw std::runtime_error(std::format("Invalid path \"{}\" at {}: {}", m_expr, pos, what));
+        };
+
+        size_t i = 0;
+        while (i < expr.size()) {
+            if (expr[i] == '[') {
+                auto close = expr.find(']', i);
+                if (close == std::string_view::npos)
+                    fail(i, "unterminated index");
+
+                auto inner = expr.substr(i + 1, close - i - 1);
+                if (inner == "*") {
+                    m_steps.push_back({StepKind::AnyIndex});
+                } else {
+                    if (inner.empty() || inner.find_first_not_of("0123456789") != std::string_view::npos)
+                        fail(i, "index must be a number or *");
+                    size_t index = 0;
+                    if (std::from_chars(inner.data(), inner.data() + inner.size(), index).ec == std::errc::result_out_of_range)
+                        fail(i, "index out of range");
+                    m_steps.push_back({StepKind::Index, {}, index});
+                }
+                i = close + 1;
+            } else {
+                // keys come first or follow a dot
+                if (!m_steps.empty()) {
+                    if (expr[i] != '.')
+                        fail(i, "expected . or [");
+                    i++;
+                }
+
+                if (i < expr.size() && expr[i] == '"') {
+                    auto close = expr.find('"', i + 1);
+                    if (close == std::string_view::npos)
+                        fail(i, "unterminated quoted key");
+                    m_steps.push_back({StepKind::Key, std::string(expr.substr(i + 1, close - i - 1))});
+                    i = close + 1;
+                } else {
+                    auto end = std::min(expr.find_first_of(".[]\"", i), expr.size());
+                    auto key = expr.substr(i, end - i);
+                    if (key.empty())
+                        fail(i, "empty key");
+                    if (key == "*")
+                        m_steps.push_back({StepKind::AnyKey});
+                    else
+                        m_steps.push_back({StepKind::Key, std::string(key)});
+                    i = end;
+                }
+            }
+        }
+    }
+
+    void PathQuery::run(StreamReader& reader, const std::function<bool(TagID, StreamReader&)>& onMatch) const {
+        if (checkedRead<TagID>(reader) != TagID::Compound)
+            throw std::runtime_error("Root tag is not a compound");
+        checkedSkip(reader, checkedRead<uint16_t>(reader));
+
+        walk(reader, TagID::Compound, 0, onMatch);
+    }
+
+    bool PathQuery::walk(StreamReader& reader, TagID id, size_t step,
+                         const std::function<bool(TagID, StreamReader&)>& onMatch) const {
+        if (step == m_steps.size())
+            return onMatch(id, reader);
+
+        const auto& s = m_steps[step];
+        switch (s.kind) {
+        case StepKind::Key:
+        case StepKind::AnyKey: {
+            if (id != TagID::Compound)
+                break;
+
+            while (true) {
+                auto tag = checkedRead<TagID>(reader);
+                if (tag == TagID::End)
+                    return true;
+
+                auto len = checkedRead<uint16_t>(reader);
+                // most keys are rejected by their length alone
+                auto matches = s.kind == StepKind::AnyKey || len == s.key.size();
+                if (matches && s.kind == StepKind::Key) {
+                    ensureAvailable(reader, len);
+                    matches = memcmp(reader.remaining().data(), s.key.data(), len) == 0;
+                }
+                checkedSkip(reader, len);
+
+                // the tag at a step is nested as deep as the step's index
+                if (!matches)
+                    skipPayload(reader, tag, step + 1);
+                else if (!walk(reader, tag, step + 1, onMatch))
+                    return false;
+            }
+        }
+        case StepKind::Index:
+        case StepKind::AnyIndex: {
+            // array elements are treated like scalar tags of the element type
+            auto itemsID = id == TagID::ByteArray   ? TagID::Byte
+                           : id == TagID::IntArray  ? TagID::Int
+                           : id == TagID::LongArray ? TagID::Long
+                           : id == TagID::List      ? checkedRead<TagID>(reader)
+                                                    : TagID::None;
+            if (itemsID == TagID::None)
+                break;
+
+            size_t len = checkedRead<uint32_t>(reader);
+            size_t begin = s.kind == StepKind::Index ? std::min(s.index, len) : 0;
+            size_t end = s.kind == StepKind::Index ? begin + (begin < len) : len;
+
+            skipListItems(reader, itemsID, begin, step + 1);
+            for (auto i = begin; i < end; i++) {
+                if (!walk(reader, itemsID, step + 1, onMatch))
+                    return false;
+            }
+            skipListItems(reader, itemsID, len - end, step + 1);
+            return true;
+        }
+        }
+
+        // the path does not continue through this tag
+        skipPayload(reader, id, step);
+        return true;
+    }
+
+    std::vector<std::unique_ptr<Value>> PathQuery::select(std::span<uint8_t> bytes) const {
+        std::vector<std::unique_ptr<Value>> out;
+        auto r = StreamReader(bytes);
+        run(r, [&](TagID id, StreamReader& reader) {
+            out.emplace_back(valueForID(reader, id));
+            return true;
+        });
+        return out;
+    }
+
+    std::vector<std::unique_ptr<Value>> PathQuery::select(StreamSource& source) const {
+        std::vector<std::unique_ptr<Value>> out;
+        auto r = StreamReader(source);
+        run(r, [&](TagID id, StreamReader& reader) {
+            out.emplace_back(valueForID(reader, id));
+            return true;
+        });
+        return out;
+    }
+
+    std::vector<Value*> PathQuery::select(std::span<uint8_t> bytes, Document& doc) const {
+        doc.reset();
+
+        std::vector<Value*> out;
+        auto r = StreamReader(bytes);
+        run(r, [&](TagID id, StreamReader& reader) {
+            out.push_back(valueForID(reader, id, doc.getResource()));
+            return true;
+        });
+        return out;
+    }
+
+    std::unique_ptr<Value> PathQuery::first(std::span<uint8_t> bytes) const {
+        std::unique_ptr<Value> out;
+        auto r = StreamReader(bytes);
+        run(r, [&](TagID id, StreamReader& reader) {
+            out.reset(valueForID(reader, id));
+            return false;
+        });
+        return out;
+    }
+
+    std::unique_ptr<Value> PathQuery::first(StreamSource& source) const {
+        std::unique_ptr<Value> out;
+        auto r = StreamReader(source);
+        run(r, [&](TagID id, StreamReader& reader) {
+            out.reset(valueForID(reader, id));
+            return false;
+        });
+        return out;
+    }
+
+    std::vector<NbtView> PathQuery::view(std::span<uint8_t> bytes) const {
+        std::vector<NbtView> out;
+        auto r = StreamReader(bytes);
+        run(r, [&](TagID id, StreamReader& reader) {
+            out.emplace_back(id, reader.remaining());
+            skipPayload(reader, id);
+            return true;
+        });
+        return out;
+    }
+} // namespace nbt
@@ -0,0 +1,63 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <span>
+
+#include "Tags.hpp"
+#include "NbtView.hpp"
+
+namespace nbt {
+    class Value;
+    class Document;
+
+    // A path expression compiled once and then matched directly against serialized NBT, e.g.
+    // `Level.Sections[*].BlockStates` or `Data.Player.Inventory[3].id`. Steps are separated by dots:
+    //  - `name` or `"name with.dots"` selects a key of a compound, `*` any key
+    //  - `[n]` selects the n-th item of a list or array, `[*]` every item
+    // Everything which does not match is skipped over without being decoded, so only the matches cost anything.
+    // An empty expression matches the root compound itself.
+    class PathQuery {
+      public:
+        // throws on syntax errors
+        PathQuery(std::string_view expr);
+
+        inline const std::string& expression() const { return m_expr; }
+
+        // every match in document order
+        std::vector<std::unique_ptr<Value>> select(std::span<uint8_t> bytes) const;
+        std::vector<std::unique_ptr<Value>> select(StreamSource& source) const;
+        // matches are allocated in the document's arena (the document itself is reset)
+        std::vector<Value*> select(std::span<uint8_t> bytes, Document& doc) const;
+        // stops scanning at the first match, nullptr if there is none
+        std::unique_ptr<Value> first(std::span<uint8_t> bytes) const;
+        std::unique_ptr<Value> first(StreamSource& source) const;
+        // nothing is decoded at all, the views point into `bytes`
+        std::vector<NbtView> view(std::span<uint8_t> bytes) const;
+
+        // Walks a whole NBT file (root tag included) and calls `onMatch` with the reader positioned at the payload of
+        // every matching tag. The callback has to consume exactly that payload and returns whether to keep going.
+        void run(StreamReader& reader, const std::function<bool(TagID, StreamReader&)>& onMatch) const;
+
+      private:
+        enum class StepKind {
+            Key,
+            AnyKey,
+            Index,
+            AnyIndex
+        };
+
+        struct Step {
+            StepKind kind;
+            std::string key;
+            size_t index = 0;
+        };
+
+        bool walk(StreamReader& reader, TagID id, size_t step, const std::function<bool(TagID, StreamReader&)>& onMatch) const;
+
+        std::string m_expr;
+        std::vector<Step> m_steps;
+    };
+} // namespace nbt
@@ -0,0 +1,115 @@
+#include "RegionFile.hpp"
+
+#include <numeric>
+
+namespace nbt {
+    RegionFile::RegionFile(const std::string& path) : m_file(path, MapAccess::Random) {
+        if (m_file.size() < HeaderSize)
+            throw std::runtime_error(std::format("\"{}\" is not a region file (only {} bytes)", path, m_file.size()));
+
+        auto r = StreamReader(m_file.bytes());
+        for (auto& location : m_locations) {
+            auto entry = r.read<uint32_t>();
+            location.offset = entry >> 8;
+            location.sectors = entry & 0xFF;
+        }
+        for (auto& timestamp : m_timestamps) {
+            timestamp = r.read<uint32_t>();
+        }
+    }
+
+    ChunkCompression RegionFile::getCompression(size_t index) const {
+        rawChunk(index); // validates the location
+        return static_cast<ChunkCompression>(m_file.bytes()[m_locations[index].offset * SectorSize + 4]);
+    }
+
+    std::span<uint8_t> RegionFile::rawChunk(size_t index) const {
+        if (!hasChunk(index))
+            throw std::runtime_error(std::format("Chunk {} is not present in the region", index));
+
+        auto start = size_t(m_locations[index].offset) * SectorSize;
+        if (start < HeaderSize || start + 5 > m_file.size())
+            throw std::runtime_error(std::format("Chunk {} points outside of the region file", index));
+
+        auto r = StreamReader(m_file.bytes().subspan(start));
+        auto len = r.read<uint32_t>();
+        if (!len || start + 4 + len > m_file.size())
+            throw std::runtime_error(std::format("Chunk {} has an invalid length {}", index, len));
+
+        return m_file.bytes().subspan(start + 5, len - 1);
+    }
+
+    void RegionFile::readChunkInto(size_t index, CompoundValue& val, InflateSource* inflater) const {
+        auto data = rawChunk(index);
+        auto compression = getCompression(index);
+
+        switch (compression) {
+        case ChunkCompression::None: {
+            readRoot(data, val);
+        } break;
+        case ChunkCompression::GZip:
+        case ChunkCompression::Zlib: {
+            auto format = compression == ChunkCompression::GZip ? Compression::Gzip : Compression::Zlib;
+            auto& backend = backendFor(format);
+            if (!backend.canStream(format)) {
+                // e.g. libdeflate, which inflates the whole chunk at once and is faster doing so
+                auto raw = backend.decompress(data, format);
+                readRoot(raw, val);
+            } else if (inflater) {
+                inflater->reset(data);
+                auto r = StreamReader(*inflater);
+                readRoot(r, val);
+            } else {
+                auto source = InflateSource(data);
+                auto r = StreamReader(source);
+                readRoot(r, val);
+            }
+        } break;
+        default: {
+            if (static_cast<uint8_t>(compression) & static_cast<uint8_t>(ChunkCompression::External))
+                throw std::runtime_error(std::format("Chunk {} is stored in an external .mcc file", index));
+            throw std::runtime_error(std::format("Chunk {} uses an unsupported compression {}", index,
+                                                 static_cast<int>(compression)));
+        } break;
+        }
+    }
+
+    CompoundValue RegionFile::readChunk(size_t index) const {
+        CompoundValue val;
+        readChunkInto(index, val, nullptr);
+        return val;
+    }
+
+    CompoundValue& RegionFile::readChunk(size_t index, Document& doc) const {
+        doc.reset();
+        readChunkInto(index, doc.root(), nullptr);
+        return doc.root();
+    }
+
+    std::vector<std::unique_ptr<CompoundValue>> RegionFile::readChunks(std::span<const size_t> indices, ThreadPool& pool) const {
+        std::vector<std::unique_ptr<CompoundValue>> chunks(indices.size());
+        std::vector<std::unique_ptr<InflateSource>> inflaters(pool.size() + 1);
+
+        pool.parallelFor(indices.size(), [&](size_t slot, size_t i) {
+            auto index = indices[i];
+            if (!hasChunk(index))
+                return;
+
+            auto& inflater = inflaters[slot];
+            if (!inflater)
+                inflater = std::make_unique<InflateSource>(std::span<const uint8_t>());
+
+            auto chunk = std::make_unique<CompoundValue>();
+            readChunkInto(index, *chunk, inflater.get());
+            chunks[i] = std::move(chunk);
+        });
+
+        return chunks;
+    }
+
+    std::vector<std::unique_ptr<CompoundValue>> RegionFile::readAllChunks(ThreadPool& pool) const {
+        std::array<size_t, ChunkCount> indices;
+        std::iota(indices.begin(), indices.end(), 0);
+        return readChunks(indices, pool);
+    }
+} // namespace nbt
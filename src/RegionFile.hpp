@@ -0,0 +1,65 @@
+#pragma once
+#include <array>
+#include <memory>
+#include <vector>
+#include <span>
+#include <string>
+
+#include "nbtpp.hpp"
+#include "MappedFile.hpp"
+#include "ThreadPool.hpp"
+
+namespace nbt {
+    enum class ChunkCompression : uint8_t {
+        GZip = 1,
+        Zlib = 2,
+        None = 3,
+        LZ4 = 4,
+        External = 0x80 // flag: the chunk is stored in a separate .mcc file
+    };
+
+    // Anvil region file (.mca): a table of 1024 chunk locations, a table of 1024 timestamps and the chunks,
+    // each compressed on its own and aligned to 4 KiB sectors. The file is memory-mapped, so opening it is cheap
+    // and chunks are inflated straight from the mapping.
+    class RegionFile {
+      public:
+        static constexpr size_t ChunkCount = 1024;
+        static constexpr size_t SectorSize = 4096;
+        static constexpr size_t HeaderSize = 2 * SectorSize;
+
+        struct ChunkLocation {
+            uint32_t offset = 0; // in sectors from the start of the file
+            uint8_t sectors = 0;
+        };
+
+        RegionFile(const std::string& path);
+
+        // index of a chunk from its coordinates (only the lower 5 bits matter)
+        static inline size_t indexOf(int x, int z) { return (x & 31) + (z & 31) * 32; }
+
+        inline bool hasChunk(size_t index) const { return m_locations[index].offset != 0; }
+        inline const ChunkLocation& getLocation(size_t index) const { return m_locations[index]; }
+        inline uint32_t getTimestamp(size_t index) const { return m_timestamps[index]; }
+        inline std::span<uint8_t> bytes() const { return m_file.bytes(); }
+
+        ChunkCompression getCompression(size_t index) const;
+        // the chunk data as stored in the file, still compressed
+        std::span<uint8_t> rawChunk(size_t index) const;
+
+        CompoundValue readChunk(size_t index) const;
+        CompoundValue& readChunk(size_t index, Document& doc) const;
+
+        // decodes the given chunks in parallel, one inflate stream per worker; missing chunks give nullptr
+        std::vector<std::unique_ptr<CompoundValue>> readChunks(std::span<const size_t> indices,
+                                                               ThreadPool& pool = ThreadPool::shared()) const;
+        // decodes every chunk in parallel, the result is indexed by chunk index
+        std::vector<std::unique_ptr<CompoundValue>> readAllChunks(ThreadPool& pool = ThreadPool::shared()) const;
+
+      private:
+        void readChunkInto(size_t index, CompoundValue& val, InflateSource* inflater) const;
+
+        MappedFile m_file;
+        std::array<ChunkLocation, ChunkCount> m_locations;
+        std::array<uint32_t, ChunkCount> m_timestamps;
+    };
+} // namespace nbt
@@ -0,0 +1,183 @@
+#include "RegionWriter.hpp"
+
+#include <chrono>
+#include <fstream>
+
+#include "AtomicFile.hpp"
+
+namespace nbt {
+    static void putU32(uint8_t* dst, uint32_t val) {
+        dst[0] = val >> 24;
+        dst[1] = val >> 16;
+        dst[2] = val >> 8;
+        dst[3] = val;
+    }
+
+    // the sector count of a location entry is a single byte, a bigger one would run into the offset
+    static uint32_t packLocation(size_t index, size_t offset, size_t sectors) {
+        if (sectors > 0xFF)
+            throw std::runtime_error(std::format("Chunk {} is too big for a region file ({} sectors)", index, sectors));
+        return static_cast<uint32_t>(offset << 8 | sectors);
+    }
+
+    RegionWriter::RegionWriter(ThreadPool& pool, int level) : m_pool(pool), m_level(level) {}
+
+    void RegionWriter::setChunk(size_t index, const CompoundValue* chunk, uint32_t timestamp) {
+        if (!timestamp) {
+            auto now = std::chrono::system_clock::now().time_since_epoch();
+            timestamp = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(now).count());
+        }
+
+        m_entries.at(index) = {chunk, timestamp, {}};
+        m_dirty[index] = true;
+    }
+
+    void RegionWriter::removeChunk(size_t index) {
+        m_entries.at(index) = {};
+        m_dirty[index] = true;
+    }
+
+    size_t RegionWriter::sectorsFor(size_t bytes) {
+        return (bytes + RegionFile::SectorSize - 1) / RegionFile::SectorSize;
+    }
+
+    void RegionWriter::encodeDirty() {
+        std::vector<size_t> pending;
+        for (size_t i = 0; i < RegionFile::ChunkCount; i++) {
+            if (m_dirty[i] && m_entries[i].chunk && m_entries[i].encoded.empty())
+                pending.push_back(i);
+        }
+
+        auto& backend = backendFor(Compression::Zlib);
+        m_pool.parallelFor(pending.size(), [&](size_t slot, size_t i) {
+            auto& entry = m_entries[pending[i]];
+            auto bytes = saveToBytes(entry.chunk);
+
+            std::vector<uint8_t> encoded(5 + backend.compressBound(bytes.size(), Compression::Zlib));
+            auto compLen = backend.compress(bytes, std::span(encoded).subspan(5), Compression::Zlib, m_level);
+
+            encoded.resize(5 + compLen);
+            putU32(encoded.data(), static_cast<uint32_t>(compLen + 1));
+            encoded[4] = static_cast<uint8_t>(ChunkCompression::Zlib);
+
+            // only the first error is rethrown, every chunk which is too big has to stay unencoded
+            if (sectorsFor(encoded.size()) > 0xFF)
+                throw std::runtime_error(std::format("Chunk {} is too big for a region file ({} bytes)", pending[i], compLen));
+            entry.encoded = std::move(encoded);
+        });
+    }
+
+    void RegionWriter::write(const std::string& path) {
+        encodeDirty();
+
+        std::vector<uint8_t> file(RegionFile::HeaderSize);
+        for (size_t i = 0; i < RegionFile::ChunkCount; i++) {
+            const auto& entry = m_entries[i];
+            if (!entry.chunk)
+                continue;
+
+            auto offset = file.size() / RegionFile::SectorSize;
+            auto sectors = sectorsFor(entry.encoded.size());
+            putU32(&file[i * 4], packLocation(i, offset, sectors));
+            putU32(&file[RegionFile::SectorSize + i * 4], entry.timestamp);
+
+            file.insert(file.end(), entry.encoded.begin(), entry.encoded.end());
+            file.resize((offset + sectors) * RegionFile::SectorSize);
+        }
+
+        writeFileAtomically(path, file);
+
+        m_dirty.fill(false);
+    }
+
+    bool RegionWriter::update(const std::string& path) {
+        encodeDirty();
+
+        std::vector<uint8_t> file;
+        std::array<RegionFile::ChunkLocation, RegionFile::ChunkCount> locations;
+        std::array<uint32_t, RegionFile::ChunkCount> timestamps;
+        bool inPlace = true;
+
+        {
+            auto region = RegionFile(path);
+            for (size_t i = 0; i < RegionFile::ChunkCount; i++) {
+                locations[i] = region.getLocation(i);
+                timestamps[i] = region.getTimestamp(i);
+                if (m_dirty[i] && m_entries[i].chunk && sectorsFor(m_entries[i].encoded.size()) > locations[i].sectors)
+                    inPlace = false;
+            }
+
+            if (!inPlace) {
+                // compact: dirty chunks get their new data, clean ones are copied over byte for byte
+                file.resize(RegionFile::HeaderSize);
+                for (size_t i = 0; i < RegionFile::ChunkCount; i++) {
+                    std::span<const uint8_t> data;
+                    auto timestamp = timestamps[i];
+                    if (m_dirty[i]) {
+                        data = m_entries[i].encoded;
+                        timestamp = m_entries[i].timestamp;
+                    } else if (region.hasChunk(i)) {
+                        auto raw = region.rawChunk(i);
+                        data = {raw.data() - 5, raw.size() + 5};
+                    }
+                    if (data.empty())
+                        continue;
+
+                    auto offset = file.size() / RegionFile::SectorSize;
+                    auto sectors = sectorsFor(data.size());
+                    putU32(&file[i * 4], packLocation(i, offset, sectors));
+                    putU32(&file[RegionFile::SectorSize + i * 4], timestamp);
+
+                    file.insert(file.end(), data.begin(), data.end());
+                    file.resize((offset + sectors) * RegionFile::SectorSize);
+                }
+            }
+        }
+
+        if (!inPlace) {
+            writeFileAtomically(path, file);
+
+            m_dirty.fill(false);
+            return false;
+        }
+
+        auto f = std::fstream(path, std::ios::binary | std::ios::in | std::ios::out);
+        if (!f)
+            throw std::runtime_error(std::format("Failed to open file \"{}\" for saving", path));
+
+        for (size_t i = 0; i < RegionFile::ChunkCount; i++) {
+            if (!m_dirty[i])
+                continue;
+
+            const auto& entry = m_entries[i];
+            uint8_t location[4] = {};
+            uint8_t timestamp[4] = {};
+            if (entry.chunk) {
+                auto sectors = sectorsFor(entry.encoded.size());
+                putU32(location, packLocation(i, locations[i].offset, sectors));
+                putU32(timestamp, entry.timestamp);
+
+                // pad to the sector boundary so no stale bytes of the old chunk are left behind
+                static constexpr char zeros[RegionFile::SectorSize] = {};
+                f.seekp(size_t(locations[i].offset) * RegionFile::SectorSize);
+                f.write((const char*)entry.encoded.data(), entry.encoded.size());
+                f.write(zeros, sectors * RegionFile::SectorSize - entry.encoded.size());
+            }
+
+            f.seekp(i * 4);
+            f.write((char*)location, 4);
+            f.seekp(RegionFile::SectorSize + i * 4);
+            f.write((char*)timestamp, 4);
+        }
+        // a failed write (a full disk...) must not pass for a saved chunk, the chunks stay dirty
+        f.flush();
+        if (!f)
+            throw std::runtime_error(std::format("Failed to write file \"{}\"", path));
+        f.close();
+        if (!f)
+            throw std::runtime_error(std::format("Failed to write file \"{}\"", path));
+
+        m_dirty.fill(false);
+        return true;
+    }
+} // namespace nbt
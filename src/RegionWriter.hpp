@@ -0,0 +1,47 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <string>
+#include <optional>
+
+#include "RegionFile.hpp"
+
+namespace nbt {
+    // Builds region files (.mca) out of chunk trees. Chunks are serialized and zlib-compressed (by the preferred
+    // backend, see backendFor) concurrently on a thread pool and then packed into 4 KiB sectors with matching location and timestamp tables.
+    class RegionWriter {
+      public:
+        // level is passed to the compression backend, DefaultLevel for its default one
+        RegionWriter(ThreadPool& pool = ThreadPool::shared(), int level = DefaultLevel);
+
+        // the chunk is not owned and has to stay alive until the next write/update; 0 timestamp means now
+        void setChunk(size_t index, const CompoundValue* chunk, uint32_t timestamp = 0);
+        // the chunk will be deleted from the file
+        void removeChunk(size_t index);
+        inline bool isDirty(size_t index) const { return m_dirty[index]; }
+
+        // writes a fresh, compact region file containing only the chunks given to this writer, replacing the old one
+        // atomically (see writeFileAtomically)
+        void write(const std::string& path);
+
+        // Rewrites the dirty chunks of an existing region file, chunks which were not touched are kept as they are.
+        // Chunks whose new data fits into their old sectors are written in place, if any of them doesn't the whole
+        // file is compacted instead. Returns true if the update happened in place.
+        bool update(const std::string& path);
+
+      private:
+        struct Entry {
+            const CompoundValue* chunk = nullptr;
+            uint32_t timestamp = 0;
+            std::vector<uint8_t> encoded; // length, compression type and compressed data, not padded
+        };
+
+        void encodeDirty();
+        static size_t sectorsFor(size_t bytes);
+
+        ThreadPool& m_pool;
+        int m_level;
+        std::array<Entry, RegionFile::ChunkCount> m_entries;
+        std::array<bool, RegionFile::ChunkCount> m_dirty {};
+    };
+} // namespace nbt
@@ -0,0 +1,796 @@
+#include "nbtpp.hpp"
+#include <charconv>
+#include <cmath>
+#include <format>
+
+namespace nbt {
+    // writer
+
+    Visit SnbtWriter::beginCompound() {
+        beginValue();
+        open('{', m_pretty);
+        return Visit::Continue;
+    }
+
+    void SnbtWriter::endCompound() {
+        close('}');
+    }
+
+    Visit SnbtWriter::beginList(TagID itemsID, size_t length) {
+        beginValue();
+        // numbers and strings stay on one line, containers get a line each
+        auto containers = itemsID == TagID::Compound || itemsID == TagID::List || itemsID == TagID::ByteArray ||
+                          itemsID == TagID::IntArray || itemsID == TagID::LongArray;
+        open('[', m_pretty && containers);
+        return Visit::Continue;
+    }
+
+    void SnbtWriter::endList() {
+        close(']');
+    }
+
+    Visit SnbtWriter::key(std::string_view key, TagID id) {
+        auto& level = m_levels.back();
+        if (!level.first)
+            m_out += ',';
+        level.first = false;
+        if (level.multiline)
+            newline(m_levels.size());
+
+        auto plain = !key.empty();
+        for (auto c : key) {
+            if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '.' || c == '+' ||
+                  c == '-')) {
+                plain = false;
+                break;
+            }
+        }
+        if (plain)
+            m_out += key;
+        else
+            quoted(key);
+
+        m_out += m_pretty ? ": " : ":";
+        m_afterKey = true;
+        return Visit::Continue;
+    }
+
+    void SnbtWriter::string(std::string_view value) {
+        beginValue();
+        quoted(value);
+    }
+
+    Visit SnbtWriter::beginArray(TagID id, size_t length) {
+        beginValue();
+        m_out += id == TagID::ByteArray ? "[B;" : id == TagID::IntArray ? "[I;" : "[L;";
+        // the elements are separated by arrayChunk itself
+        m_levels.push_back({true, false});
+        if (m_pretty && length)
+            m_out += ' ';
+        return Visit::Continue;
+    }
+
+    void SnbtWriter::endArray() {
+        m_levels.pop_back();
+        m_out += ']';
+    }
+
+    void SnbtWriter::beginValue() {
+        if (m_afterKey) {
+            m_afterKey = false;
+            return;
+        }
+        // the root value
+        if (m_levels.empty())
+            return;
+
+        auto& level = m_levels.back();
+        if (!level.first)
+            m_out += ',';
+        if (level.multiline)
+            newline(m_levels.size());
+        else if (m_pretty && !level.first)
+            m_out += ' ';
+        level.first = false;
+    }
+
+    void SnbtWriter::newline(size_t depth) {
+        m_out += '\n';
+        m_out.append(depth * 4, ' ');
+    }
+
+    void SnbtWriter::open(char bracket, bool multiline) {
+        m_out += bracket;
+        m_levels.push_back({true, multiline});
+    }
+
+    void SnbtWriter::close(char bracket) {
+        auto level = m_levels.back();
+        m_levels.pop_back();
+        if (level.multiline && !level.first)
+            newline(m_levels.size());
+        m_out += bracket;
+    }
+
+    template <typename T>
+    static void appendInteger(std::string& out, T value, char suffix) {
+        char buf[24];
+        auto end = std::to_chars(buf, buf + sizeof(buf), value).ptr;
+        if (suffix)
+            *end++ = suffix;
+        out.append(buf, end);
+    }
+
+    // shortest text which reads back as the same value
+    template <typename T>
+    static void appendFloat(std::string& out, T value, char suffix) {
+        if (std::isnan(value)) {
+            out += "NaN";
+        } else if (std::isinf(value)) {
+            out += value < 0 ? "-Infinity" : "Infinity";
+        } else {
+            char buf[32];
+            auto end = std::to_chars(buf, buf + sizeof(buf), value).ptr;
+            out.append(buf, end);
+        }
+        out += suffix;
+    }
+
+    void SnbtWriter::number(char value) {
+        appendInteger(m_out, static_cast<int>(static_cast<signed char>(value)), 'b');
+    }
+
+    void SnbtWriter::number(short value) {
+        appendInteger(m_out, value, 's');
+    }
+
+    void SnbtWriter::number(int value) {
+        appendInteger(m_out, value, 0);
+    }
+
+    void SnbtWriter::number(long long value) {
+        appendInteger(m_out, value, 'L');
+    }
+
+    void SnbtWriter::number(float value) {
+        appendFloat(m_out, value, 'f');
+    }
+
+    void SnbtWriter::number(double value) {
+        appendFloat(m_out, value, 'd');
+    }
+
+    void SnbtWriter::quoted(std::string_view str) {
+        static constexpr char hex[] = "0123456789abcdef";
+
+        m_out += '"';
+        size_t run = 0;
+        for (size_t i = 0; i < str.size(); i++) {
+            auto c = static_cast<unsigned char>(str[i]);
+            if (c >= 0x20 && c != '"' && c != '\\')
+                continue;
+
+            // copy everything up to the character that needs escaping at once
+            m_out.append(str.data() + run, i - run);
+            run = i + 1;
+            m_out += '\\';
+            switch (c) {
+            case '"':
+            case '\\':
+                m_out += static_cast<char>(c);
+                break;
+            case '\n':
+                m_out += 'n';
+                break;
+            case '\r':
+                m_out += 'r';
+                break;
+            case '\t':
+                m_out += 't';
+                break;
+            case '\b':
+                m_out += 'b';
+                break;
+            case '\f':
+                m_out += 'f';
+                break;
+            default:
+                m_out += 'x';
+                m_out += hex[c >> 4];
+                m_out += hex[c & 15];
+            }
+        }
+        m_out.append(str.data() + run, str.size() - run);
+        m_out += '"';
+    }
+
+    // walks a tree emitting the same events parseEvents would for its binary form
+    static void writeValue(SnbtWriter& writer, const Value* val) {
+        switch (val->getID()) {
+        case TagID::Compound: {
+            writer.beginCompound();
+            for (auto& [key, child] : static_cast<const CompoundValue*>(val)->getItems()) {
+                writer.key(key, child->getID());
+                writeValue(writer, child);
+            }
+            writer.endCompound();
+        } break;
+        case TagID::List: {
+            auto list = static_cast<const ListValue*>(val);
+            writer.beginList(list->getItemsID(), list->length());
+            if (list->isUnboxed()) {
+                std::visit(
+                    [&](auto& numbers) {
+                        if constexpr (!std::is_same_v<std::decay_t<decltype(numbers)>, std::monostate>) {
+                            for (auto x : numbers)
+                                writer.scalar(x);
+                        }
+                    },
+                    list->getNumberStorage());
+            } else {
+                for (auto item : list->getItems())
+                    writeValue(writer, item);
+            }
+            writer.endList();
+        } break;
+        case TagID::ByteArray: {
+            auto& items = static_cast<const ByteArrayValue*>(val)->getItems();
+            writer.beginArray(TagID::ByteArray, items.size());
+            writer.arrayChunk(std::span<const char>(items));
+            writer.endArray();
+        } break;
+        case TagID::IntArray: {
+            auto& items = static_cast<const IntArrayValue*>(val)->getItems();
+            writer.beginArray(TagID::IntArray, items.size());
+            writer.arrayChunk(std::span<const int>(items));
+            writer.endArray();
+        } break;
+        case TagID::LongArray: {
+            auto& items = static_cast<const LongArrayValue*>(val)->getItems();
+            writer.beginArray(TagID::LongArray, items.size());
+            writer.arrayChunk(std::span<const long long>(items));
+            writer.endArray();
+        } break;
+        default: {
+            std::visit(
+                [&](auto& value) {
+                    if constexpr (std::is_same_v<std::decay_t<decltype(value)>, std::pmr::string>)
+                        writer.string(value);
+                    else
+                        writer.scalar(value);
+                },
+                static_cast<const SimpleValue*>(val)->get());
+        }
+        }
+    }
+
+    void writeSnbt(std::string& out, const Value* val, SnbtStyle style) {
+        auto writer = SnbtWriter(out, style);
+        writeValue(writer, val);
+    }
+
+    std::string saveToSnbt(const Value* val, SnbtStyle style) {
+        std::string out;
+        writeSnbt(out, val, style);
+        return out;
+    }
+
+    // parser
+
+    namespace {
+        using Number = std::variant<char, short, int, long long, float, double>;
+
+        inline bool isPlainChar(char c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '.' || c == '+' ||
+                   c == '-';
+        }
+
+        inline void freeValue(Value* val) {
+            Value::release(val);
+        }
+
+        template <typename T>
+        bool parseInteger(std::string_view text, T& out) {
+            if (!text.empty() && text[0] == '+')
+                text.remove_prefix(1);
+            // like the game, no leading zeros
+            auto digits = !text.empty() && text[0] == '-' ? text.substr(1) : text;
+            if (digits.empty() || digits[0] < '0' || digits[0] > '9' || (digits.size() > 1 && digits[0] == '0'))
+                return false;
+
+            auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+            return ec == std::errc() && ptr == text.data() + text.size();
+        }
+
+        // digits with an optional point and exponent; a double without suffix needs the point
+        template <typename T>
+        bool parseFloat(std::string_view text, T& out, bool needPoint) {
+            if (!text.empty() && text[0] == '+')
+                text.remove_prefix(1);
+            auto body = !text.empty() && text[0] == '-' ? text.substr(1) : text;
+            if (body == "NaN" || body == "Infinity") {
+                if (needPoint)
+                    return false;
+                out = body == "NaN" ? std::numeric_limits<T>::quiet_NaN() : std::numeric_limits<T>::infinity();
+                if (text[0] == '-')
+                    out = -out;
+                return true;
+            }
+
+            if (body.empty() || !((body[0] >= '0' && body[0] <= '9') || body[0] == '.'))
+                return false;
+            auto point = false, digit = false;
+            for (auto c : body) {
+                if (c == '.')
+                    point = true;
+                else if (c >= '0' && c <= '9')
+                    digit = true;
+                else if (c != 'e' && c != 'E' && c != '-' && c != '+')
+                    return false;
+                else
+                    break;
+            }
+            if (!digit || (needPoint && !point))
+                return false;
+
+            auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+            return ec == std::errc() && ptr == text.data() + text.size();
+        }
+
+        // what an unquoted token means, the same rules as the game: a number if it has the shape of one and fits,
+        // otherwise a string
+        bool parseNumber(std::string_view token, Number& out) {
+            if (token == "true" || token == "false") {
+                out = static_cast<char>(token == "true");
+                return true;
+            }
+
+            auto c = token.back();
+            auto body = token.substr(0, token.size() - 1);
+            switch (c) {
+            case 'b':
+            case 'B': {
+                signed char v;
+                if (parseInteger(body, v))
+                    return out = static_cast<char>(v), true;
+            } break;
+            case 's':
+            case 'S': {
+                short v;
+                if (parseInteger(body, v))
+                    return out = v, true;
+            } break;
+            case 'l':
+            case 'L': {
+                long long v;
+                if (parseInteger(body, v))
+                    return out = v, true;
+            } break;
+            case 'f':
+            case 'F': {
+                float v;
+                if (parseFloat(body, v, false))
+                    return out = v, true;
+            } break;
+            case 'd':
+            case 'D': {
+                double v;
+                if (parseFloat(body, v, false))
+                    return out = v, true;
+            } break;
+            default: {
+                int i;
+                if (parseInteger(token, i))
+                    return out = i, true;
+                double d;
+                if (parseFloat(token, d, true))
+                    return out = d, true;
+            }
+            }
+            return false;
+        }
+
+        TagID numberID(const Number& number) {
+            return std::visit([](auto v) { return scalarTagID<decltype(v)>(); }, number);
+        }
+
+        // recursive descent over the text; every value is allocated on the resource and freed again if parsing fails
+        class SnbtParser {
+          public:
+            SnbtParser(std::string_view text, std::pmr::memory_resource* resource) : m_text(text), m_resource(resource), m_keys(keyTableFor(resource)) {}
+
+            Value* parseDocument() {
+                auto val = parseValue(0);
+                skipSpace();
+                if (m_pos != m_text.size()) {
+                    freeValue(val);
+                    fail("trailing characters");
+                }
+                return val;
+            }
+
+            // the root compound goes into an existing value
+            void parseRoot(CompoundValue& root) {
+                skipSpace();
+                if (!consume('{'))
+                    fail("expected a compound");
+                parseCompoundItems(root, 0);
+                skipSpace();
+                if (m_pos != m_text.size())
+                    fail("trailing characters");
+            }
+
+          private:
+            [[noreturn]] void fail(const char* what) {
+                throw std::runtime_error(std::format("Malformed SNBT at offset {}: {}", m_pos, what));
+            }
+
+            void skipSpace() {
+                while (m_pos < m_text.size()) {
+                    auto c = m_text[m_pos];
+                    if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+                        break;
+                    m_pos++;
+                }
+            }
+
+            inline bool consume(char c) {
+                if (m_pos < m_text.size() && m_text[m_pos] == c) {
+                    m_pos++;
+                    return true;
+                }
+                return false;
+            }
+
+            inline char peek() {
+                skipSpace();
+                if (m_pos == m_text.size())
+                    fail("unexpected end of text");
+                return m_text[m_pos];
+            }
+
+            void expect(char c, const char* what) {
+                if (peek() != c)
+                    fail(what);
+                m_pos++;
+            }
+
+            // a run of unquoted characters, empty if there is none
+            std::string_view plain() {
+                auto start = m_pos;
+                while (m_pos < m_text.size() && isPlainChar(m_text[m_pos]))
+                    m_pos++;
+                return m_text.substr(start, m_pos - start);
+            }
+
+            // The text of a quoted string. Points into the input unless it has escapes, then into m_buffer which is
+            // only valid until the next string.
+            std::string_view quoted() {
+                auto quote = m_text[m_pos++];
+                auto start = m_pos;
+                while (m_pos < m_text.size() && m_text[m_pos] != quote && m_text[m_pos] != '\\')
+                    m_pos++;
+                if (m_pos == m_text.size())
+                    fail("unterminated string");
+                if (m_text[m_pos] == quote)
+                    return m_text.substr(start, m_pos++ - start);
+
+                m_buffer.assign(m_text.data() + start, m_pos - start);
+                while (true) {
+                    if (m_pos == m_text.size())
+                        fail("unterminated string");
+                    auto c = m_text[m_pos++];
+                    if (c == quote)
+                        return m_buffer;
+                    if (c != '\\') {
+                        m_buffer += c;
+                        continue;
+                    }
+                    if (m_pos == m_text.size())
+                        fail("unterminated string");
+                    switch (auto e = m_text[m_pos++]) {
+                    case '\\':
+                    case '"':
+                    case '\'':
+                        m_buffer += e;
+                        break;
+                    case 'n':
+                        m_buffer += '\n';
+                        break;
+                    case 'r':
+                        m_buffer += '\r';
+                        break;
+                    case 't':
+                        m_buffer += '\t';
+                        break;
+                    case 'b':
+                        m_buffer += '\b';
+                        break;
+                    case 'f':
+                        m_buffer += '\f';
+                        break;
+                    case 's':
+                        m_buffer += ' ';
+                        break;
+                    case 'x':
+                        appendCodePoint(hexDigits(2), false);
+                        break;
+                    case 'u':
+                        appendCodePoint(hexDigits(4), true);
+                        break;
+                    case 'U':
+                        appendCodePoint(hexDigits(8), true);
+                        break;
+                    default:
+                        m_pos--;
+                        fail("invalid escape");
+                    }
+                }
+            }
+
+            uint32_t hexDigits(size_t count) {
+                uint32_t value = 0;
+                if (m_text.size() - m_pos < count)
+                    fail("invalid escape");
+                auto [ptr, ec] = std::from_chars(m_text.data() + m_pos, m_text.data() + m_pos + count, value, 16);
+                if (ec != std::errc() || ptr != m_text.data() + m_pos + count)
+                    fail("invalid escape");
+                m_pos += count;
+                return value;
+            }
+
+            // \x is a raw byte (what the writer uses for control characters), \u and \U are encoded as UTF-8
+            void appendCodePoint(uint32_t cp, bool unicode) {
+                if (!unicode || cp < 0x80) {
+                    m_buffer += static_cast<char>(cp);
+                } else if (cp < 0x800) {
+                    m_buffer += static_cast<char>(0xC0 | (cp >> 6));
+                    m_buffer += static_cast<char>(0x80 | (cp & 0x3F));
+                } else if (cp < 0x10000) {
+                    m_buffer += static_cast<char>(0xE0 | (cp >> 12));
+                    m_buffer += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                    m_buffer += static_cast<char>(0x80 | (cp & 0x3F));
+                } else if (cp < 0x110000) {
+                    m_buffer += static_cast<char>(0xF0 | (cp >> 18));
+                    m_buffer += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+                    m_buffer += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                    m_buffer += static_cast<char>(0x80 | (cp & 0x3F));
+                } else {
+                    fail("invalid code point");
+                }
+            }
+
+            std::string_view key() {
+                auto c = peek();
+                if (c == '"' || c == '\'')
+                    return quoted();
+                auto key = plain();
+                if (key.empty())
+                    fail("expected a key");
+                return key;
+            }
+
+            // a scalar, true for a number and false for a string; quoted text is always a string
+            bool scalar(Number& number, std::string_view& string) {
+                auto c = peek();
+                if (c == '"' || c == '\'') {
+                    string = quoted();
+                    return false;
+                }
+                auto token = plain();
+                if (token.empty())
+                    fail("expected a value");
+                if (parseNumber(token, number))
+                    return true;
+                string = token;
+                return false;
+            }
+
+            Value* parseValue(size_t depth) {
+                auto c = peek();
+                if (c == '{') {
+                    m_pos++;
+                    auto val = makeValue<CompoundValue>(m_resource, m_keys);
+                    try {
+                        parseCompoundItems(*val, depth);
+                    } catch (...) {
+                        freeValue(val);
+                        throw;
+                    }
+                    return val;
+                }
+                if (c == '[')
+                    return parseListOrArray(depth);
+
+                Number number;
+                std::string_view string;
+                if (scalar(number, string))
+                    return std::visit([&](auto v) { return makeValue<SimpleValue>(m_resource, SimpleValue::SimpleType(v)); }, number);
+                return makeValue<SimpleValue>(m_resource, string);
+            }
+
+            void parseCompoundItems(CompoundValue& val, size_t depth) {
+                if (depth >= MaxDepth)
+                    fail("nested too deeply");
+
+                auto& items = val.getItems();
+                if (peek() == '}') {
+                    m_pos++;
+                    return;
+                }
+                while (true) {
+                    // keys are stored before the value is parsed, it may reuse the buffer of an escaped key
+                    auto [it, inserted] = items.emplace(key(), nullptr);
+                    Value* child;
+                    try {
+                        expect(':', "expected ':'");
+                        child = parseValue(depth + 1);
+                    } catch (...) {
+                        if (inserted)
+                            items.erase(it);
+                        throw;
+                    }
+                    // like the game, the last of duplicate keys wins
+                    if (!inserted)
+                        freeValue(it->second);
+                    it->second = child;
+
+                    if (peek() == '}') {
+                        m_pos++;
+                        return;
+                    }
+                    expect(',', "expected ',' or '}'");
+                }
+            }
+
+            template <typename T>
+            Value* parseArray(TagID id) {
+                auto val = makeValue<ArrayValue<T>>(m_resource);
+                try {
+                    auto& items = val->getItems();
+                    if (peek() == ']') {
+                        m_pos++;
+                        return val;
+                    }
+                    while (true) {
+                        skipSpace();
+                        Number number;
+                        auto token = plain();
+                        if (token.empty() || !parseNumber(token, number) || numberID(number) != scalarTagID<T>())
+                            fail(id == TagID::ByteArray ? "expected a byte" : id == TagID::IntArray ? "expected an int" : "expected a long");
+                        items.push_back(std::get<T>(number));
+                        if (peek() == ']') {
+                            m_pos++;
+                            return val;
+                        }
+                        expect(',', "expected ',' or ']'");
+                    }
+                } catch (...) {
+                    freeValue(val);
+                    throw;
+                }
+            }
+
+            Value* parseListOrArray(size_t depth) {
+                m_pos++;
+                // [B;, [I; and [L; start typed arrays, a quote is the start of a string item like [";"]
+                if (m_pos + 1 < m_text.size() && m_text[m_pos + 1] == ';' && m_text[m_pos] != '"' && m_text[m_pos] != '\'') {
+                    auto type = m_text[m_pos];
+                    if (type == 'B' || type == 'I' || type == 'L') {
+                        m_pos += 2;
+                        if (type == 'B')
+                            return parseArray<char>(TagID::ByteArray);
+                        if (type == 'I')
+                            return parseArray<int>(TagID::IntArray);
+                        return parseArray<long long>(TagID::LongArray);
+                    }
+                    fail("invalid array type");
+                }
+
+                if (depth >= MaxDepth)
+                    fail("nested too deeply");
+                if (peek() == ']') {
+                    m_pos++;
+                    return makeValue<ListValue>(m_resource, TagID::End);
+                }
+
+                auto c = peek();
+                if (c == '{' || c == '[')
+                    return parseContainerList(depth);
+                return parseScalarList();
+            }
+
+            // items are containers, parsed as values
+            Value* parseContainerList(size_t depth) {
+                auto first = parseValue(depth + 1);
+                ListValue* list;
+                try {
+                    list = makeValue<ListValue>(m_resource, first->getID());
+                } catch (...) {
+                    freeValue(first);
+                    throw;
+                }
+
+                try {
+                    auto& items = list->getItems();
+                    items.push_back(first);
+                    while (true) {
+                        if (peek() == ']') {
+                            m_pos++;
+                            return list;
+                        }
+                        expect(',', "expected ',' or ']'");
+                        auto c = peek();
+                        if (c != '{' && c != '[')
+                            fail("list items have different tags");
+                        auto item = parseValue(depth + 1);
+                        if (item->getID() != list->getItemsID()) {
+                            freeValue(item);
+                            fail("list items have different tags");
+                        }
+                        items.push_back(item);
+                    }
+                } catch (...) {
+                    freeValue(list);
+                    throw;
+                }
+            }
+
+            // numbers go straight into the unboxed storage, strings are boxed
+            Value* parseScalarList() {
+                Number number;
+                std::string_view string;
+                auto isNumber = scalar(number, string);
+                // the list takes the tag of its first item
+                auto id = isNumber ? numberID(number) : TagID::String;
+                auto list = makeValue<ListValue>(m_resource, id);
+                try {
+                    while (true) {
+                        if (isNumber)
+                            std::visit([&](auto v) { list->getNumbers<decltype(v)>().push_back(v); }, number);
+                        else
+                            list->getItems().push_back(makeValue<SimpleValue>(m_resource, string));
+
+                        if (peek() == ']') {
+                            m_pos++;
+                            return list;
+                        }
+                        expect(',', "expected ',' or ']'");
+
+                        auto start = m_pos;
+                        isNumber = scalar(number, string);
+                        if ((isNumber ? numberID(number) : TagID::String) != id) {
+                            m_pos = start;
+                            fail("list items have different tags");
+                        }
+                    }
+                } catch (...) {
+                    freeValue(list);
+                    throw;
+                }
+            }
+
+            std::string_view m_text;
+            size_t m_pos = 0;
+            std::pmr::memory_resource* m_resource;
+            KeyTable& m_keys;
+            std::string m_buffer;
+        };
+    } // namespace
+
+    Value* parseSnbtValue(std::string_view text, std::pmr::memory_resource* resource) {
+        return SnbtParser(text, resource).parseDocument();
+    }
+
+    CompoundValue loadFromSnbt(std::string_view text) {
+        CompoundValue val;
+        SnbtParser(text, heapResource()).parseRoot(val);
+        return val;
+    }
+
+    CompoundValue& loadFromSnbt(std::string_view text, Document& doc) {
+        doc.reset();
+        SnbtParser(text, doc.getResource()).parseRoot(doc.root());
+        return doc.root();
+    }
+} // namespace nbt
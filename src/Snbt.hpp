@@ -0,0 +1,94 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <span>
+#include <vector>
+#include <memory_resource>
+
+#include "EventParser.hpp"
+
+namespace nbt {
+    class Value;
+    class CompoundValue;
+    class Document;
+    inline std::pmr::memory_resource* heapResource();
+
+    enum class SnbtStyle {
+        Compact, // everything on one line without any spaces
+        Pretty   // compounds and lists of containers get one entry per line, indented by 4 spaces
+    };
+
+    // Writes SNBT (the text form the game uses in commands) into a string, appending to whatever is in it. It is a
+    // visitor, so binary NBT can be printed straight from the bytes with parseEvents(bytes, writer) without building
+    // a tree. Numbers are formatted with std::to_chars: floats and doubles print the shortest text which reads back
+    // as the same value.
+    class SnbtWriter {
+      public:
+        SnbtWriter(std::string& out, SnbtStyle style = SnbtStyle::Compact) : m_out(out), m_pretty(style == SnbtStyle::Pretty) {}
+
+        Visit beginCompound();
+        void endCompound();
+        Visit beginList(TagID itemsID, size_t length);
+        void endList();
+        Visit key(std::string_view key, TagID id);
+        // char, short, int, long long, float or double
+        template <typename T>
+        void scalar(T value) {
+            beginValue();
+            number(value);
+        }
+        void string(std::string_view value);
+        Visit beginArray(TagID id, size_t length);
+        template <typename T>
+        void arrayChunk(std::span<const T> values) {
+            for (auto value : values) {
+                if (!m_levels.back().first)
+                    m_out += m_pretty ? ", " : ",";
+                m_levels.back().first = false;
+                number(value);
+            }
+        }
+        void endArray();
+
+      private:
+        // every container which is open, innermost last
+        struct Level {
+            bool first;     // nothing has been written into it yet
+            bool multiline; // entries go on their own lines
+        };
+
+        // separator and indentation in front of a list item
+        void beginValue();
+        void newline(size_t depth);
+        void open(char bracket, bool multiline);
+        void close(char bracket);
+
+        void number(char value);
+        void number(short value);
+        void number(int value);
+        void number(long long value);
+        void number(float value);
+        void number(double value);
+        void quoted(std::string_view str);
+
+        std::string& m_out;
+        bool m_pretty;
+        bool m_afterKey = false;
+        std::vector<Level> m_levels;
+    };
+
+    // writes a value (usually a root compound) as SNBT
+    void writeSnbt(std::string& out, const Value* val, SnbtStyle style = SnbtStyle::Compact);
+    std::string saveToSnbt(const Value* val, SnbtStyle style = SnbtStyle::Compact);
+
+    // Parses SNBT into a tree. Accepts what the game writes and reads: quoted ('' or "") and unquoted strings and
+    // keys, number suffixes (b, s, L, f, d, none for Int or a double with a point), true and false as bytes, typed
+    // arrays ([B;...], [I;...], [L;...]) and lists whose items all have the same tag. Throws std::runtime_error
+    // with the offset of the first malformed character.
+    // the value is allocated on the resource like makeValue does, the default one is heapResource()
+    Value* parseSnbtValue(std::string_view text, std::pmr::memory_resource* resource = heapResource());
+    // the text has to be a compound
+    CompoundValue loadFromSnbt(std::string_view text);
+    // arena-backed overload, resets the document like loadFromBytes does
+    CompoundValue& loadFromSnbt(std::string_view text, Document& doc);
+} // namespace nbt
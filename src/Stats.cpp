@@ -0,0 +1,100 @@
+#include "Stats.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace nbt {
+    void Stats::merge(const Stats& other) {
+        for (size_t i = 0; i < PhaseCount; i++)
+            phaseNanoseconds[i] += other.phaseNanoseconds[i];
+        for (size_t i = 0; i < TagCount; i++) {
+            tagCounts[i] += other.tagCounts[i];
+            tagBytes[i] += other.tagBytes[i];
+        }
+        allocations += other.allocations;
+        allocatedBytes += other.allocatedBytes;
+        maxDepth = std::max(maxDepth, other.maxDepth);
+    }
+
+#ifdef nbtpp_stats
+    namespace detail {
+        thread_local Stats* t_stats = nullptr;
+        thread_local uint64_t t_nestedBytes = 0;
+        thread_local size_t t_depth = 0;
+        thread_local int t_phase = -1;
+        thread_local std::chrono::steady_clock::time_point t_phaseStart;
+
+        static thread_local bool t_inCall = false;
+        static std::atomic<std::shared_ptr<const StatsHook>> s_hook;
+
+        class CountingHeapResource : public std::pmr::memory_resource {
+            void* do_allocate(size_t bytes, size_t align) override {
+                countAllocation(bytes);
+                return std::pmr::new_delete_resource()->allocate(bytes, align);
+            }
+            void do_deallocate(void* ptr, size_t bytes, size_t align) override {
+                std::pmr::new_delete_resource()->deallocate(ptr, bytes, align);
+            }
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+        };
+
+        std::pmr::memory_resource* countingHeapResource() {
+            static CountingHeapResource resource;
+            return &resource;
+        }
+
+        CallStats::CallStats(std::string_view operation) : m_operation(operation) {
+            if (t_inCall)
+                return;
+            t_inCall = true;
+            m_outermost = true;
+
+            // nothing is collected when nobody would look at it
+            if (!t_stats && !s_hook.load(std::memory_order_acquire))
+                return;
+            m_outer = t_stats;
+            t_stats = &m_stats;
+            // a failed load may have left them behind
+            t_nestedBytes = 0;
+            t_depth = 0;
+            t_phase = -1;
+        }
+
+        CallStats::~CallStats() {
+            if (!m_outermost)
+                return;
+            t_inCall = false;
+            if (t_stats != &m_stats)
+                return;
+
+            t_stats = m_outer;
+            if (m_outer)
+                m_outer->merge(m_stats);
+            if (auto hook = s_hook.load(std::memory_order_acquire); hook && *hook) {
+                // the hook runs from a destructor, an exception must not escape it
+                try {
+                    (*hook)(m_operation, m_stats);
+                } catch (...) {
+                }
+            }
+        }
+    } // namespace detail
+
+    StatsScope::StatsScope(Stats& stats) : m_stats(stats), m_outer(detail::t_stats) {
+        detail::t_stats = &m_stats;
+    }
+
+    StatsScope::~StatsScope() {
+        detail::t_stats = m_outer;
+        if (m_outer)
+            m_outer->merge(m_stats);
+    }
+
+    void setStatsHook(StatsHook hook) {
+        detail::s_hook.store(hook ? std::make_shared<const StatsHook>(std::move(hook)) : nullptr, std::memory_order_release);
+    }
+#else
+    void setStatsHook(StatsHook) {}
+#endif
+} // namespace nbt
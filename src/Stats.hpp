@@ -0,0 +1,220 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <string_view>
+
+#include "Tags.hpp"
+
+namespace nbt {
+    // Instrumentation of loads and saves, compiled in with the NBTPP_STATS cmake option. Without it every hook below
+    // is an empty inline function and a StatsScope collects nothing, so the instrumented code is the same as before.
+#ifdef nbtpp_stats
+    constexpr bool StatsEnabled = true;
+#else
+    constexpr bool StatsEnabled = false;
+#endif
+
+    // where the time of a load or save goes; phases don't overlap, a nested phase pauses the one around it
+    enum class Phase : uint8_t {
+        Read,      // opening and mapping files; the pages are faulted in by whichever phase touches them first
+        Inflate,   // decompressing, including waiting for a streaming source
+        Parse,     // validating and decoding
+        Serialize, // encoding trees
+        Deflate,   // compressing
+        Write      // writing files, flush to disk included
+    };
+    constexpr size_t PhaseCount = 6;
+    // End to LongArray
+    constexpr size_t TagCount = 13;
+
+    struct Stats {
+        std::array<uint64_t, PhaseCount> phaseNanoseconds {};
+        // values read or written by tag, items of numeric lists included
+        std::array<uint64_t, TagCount> tagCounts {};
+        // Encoded bytes by tag, each byte counted once: the bytes of nested values go to their own tag, a compound
+        // keeps the tags and names of its entries and a list its header. Subtrees saved verbatim are not counted, nor
+        // are the containers saveToBytesParallel splits between threads (their children are).
+        std::array<uint64_t, TagCount> tagBytes {};
+        // allocations of the tree (nodes and what they hold), on the heap or in a Document's arena
+        uint64_t allocations = 0;
+        uint64_t allocatedBytes = 0;
+        // nesting of the deepest value, the root compound is 0
+        size_t maxDepth = 0;
+
+        inline double milliseconds(Phase phase) const { return phaseNanoseconds[static_cast<size_t>(phase)] / 1e6; }
+        inline uint64_t count(TagID id) const { return tagCounts[static_cast<size_t>(id)]; }
+        inline uint64_t bytes(TagID id) const { return tagBytes[static_cast<size_t>(id)]; }
+        // adds up the counters, maxDepth takes the larger one
+        void merge(const Stats& other);
+    };
+
+    // Collects the stats of every load and save the calling thread runs while the scope lives. Scopes nest, an inner
+    // one adds what it collected to the outer one when it ends.
+    class StatsScope {
+      public:
+#ifdef nbtpp_stats
+        StatsScope(Stats& stats);
+        ~StatsScope();
+#else
+        inline StatsScope(Stats&) {}
+#endif
+        StatsScope(const StatsScope&) = delete;
+        StatsScope& operator=(const StatsScope&) = delete;
+
+      private:
+#ifdef nbtpp_stats
+        Stats& m_stats;
+        Stats* m_outer;
+#endif
+    };
+
+    // Called after each load or save (the outermost call only, e.g. saveToCompressedFile but not the saveToBytes it
+    // runs) with the name of the function and its stats, on the thread which ran it. Pass an empty function to
+    // remove it. Does nothing without NBTPP_STATS.
+    using StatsHook = std::function<void(std::string_view operation, const Stats& stats)>;
+    void setStatsHook(StatsHook hook);
+
+    namespace detail {
+#ifdef nbtpp_stats
+        // the stats being collected on this thread, null if nobody is collecting
+        extern thread_local Stats* t_stats;
+        // encoded bytes of the values nested in the one being counted and its depth, see TagCounter
+        extern thread_local uint64_t t_nestedBytes;
+        extern thread_local size_t t_depth;
+        extern thread_local int t_phase;
+        extern thread_local std::chrono::steady_clock::time_point t_phaseStart;
+
+        // forwards to new/delete and counts into t_stats, this is what heapResource() returns
+        std::pmr::memory_resource* countingHeapResource();
+#endif
+
+        inline Stats* currentStats() {
+#ifdef nbtpp_stats
+            return t_stats;
+#else
+            return nullptr;
+#endif
+        }
+
+        inline void countAllocation(size_t bytes) {
+#ifdef nbtpp_stats
+            if (t_stats) {
+                t_stats->allocations++;
+                t_stats->allocatedBytes += bytes;
+            }
+#endif
+        }
+
+        // counts `count` values of a tag with no nested values, e.g. the items of a numeric list
+        inline void countTags(TagID id, uint64_t count, uint64_t bytes) {
+#ifdef nbtpp_stats
+            if (t_stats) {
+                t_stats->tagCounts[static_cast<size_t>(id)] += count;
+                t_stats->tagBytes[static_cast<size_t>(id)] += bytes;
+                t_nestedBytes += bytes;
+            }
+#endif
+        }
+
+        // Counts one value which starts at stream position `start` and ends where done() is called. What nested
+        // values counted in between is subtracted, so a container only keeps its own framing.
+        class TagCounter {
+          public:
+            inline TagCounter(TagID id, uint64_t start) {
+#ifdef nbtpp_stats
+                m_id = id;
+                m_start = start;
+                m_outerNested = t_nestedBytes;
+                t_nestedBytes = 0;
+                if (t_stats && t_depth > t_stats->maxDepth)
+                    t_stats->maxDepth = t_depth;
+                t_depth++;
+#endif
+            }
+
+            inline void done(uint64_t end) {
+#ifdef nbtpp_stats
+                auto total = end - m_start;
+                if (t_stats) {
+                    t_stats->tagCounts[static_cast<size_t>(m_id)]++;
+                    t_stats->tagBytes[static_cast<size_t>(m_id)] += total - t_nestedBytes;
+                }
+                t_nestedBytes = m_outerNested + total;
+                t_depth--;
+#endif
+            }
+
+          private:
+#ifdef nbtpp_stats
+            TagID m_id;
+            uint64_t m_start;
+            uint64_t m_outerNested;
+#endif
+        };
+
+        // times a phase from construction to destruction
+        class PhaseTimer {
+          public:
+            inline PhaseTimer(Phase phase) {
+#ifdef nbtpp_stats
+                if (!t_stats)
+                    return;
+                auto now = std::chrono::steady_clock::now();
+                if (t_phase >= 0)
+                    t_stats->phaseNanoseconds[t_phase] += (now - t_phaseStart).count();
+                m_outer = t_phase;
+                t_phase = static_cast<int>(phase);
+                t_phaseStart = now;
+#endif
+            }
+
+            inline ~PhaseTimer() {
+#ifdef nbtpp_stats
+                if (!t_stats || m_outer == Inactive)
+                    return;
+                auto now = std::chrono::steady_clock::now();
+                t_stats->phaseNanoseconds[t_phase] += (now - t_phaseStart).count();
+                t_phase = m_outer;
+                t_phaseStart = now;
+#endif
+            }
+
+            PhaseTimer(const PhaseTimer&) = delete;
+            PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+          private:
+#ifdef nbtpp_stats
+            static constexpr int Inactive = -2;
+            int m_outer = Inactive;
+#endif
+        };
+
+        // Wraps a public load or save: the outermost one on the thread collects into its own Stats when there is a
+        // scope or a hook to give them to, and hands them over when it ends.
+        class CallStats {
+          public:
+#ifdef nbtpp_stats
+            CallStats(std::string_view operation);
+            ~CallStats();
+#else
+            inline CallStats(std::string_view) {}
+            // user-provided, so a CallStats local doesn't count as unused
+            inline ~CallStats() {}
+#endif
+            CallStats(const CallStats&) = delete;
+            CallStats& operator=(const CallStats&) = delete;
+
+#ifdef nbtpp_stats
+          private:
+            std::string_view m_operation;
+            bool m_outermost = false;
+            Stats m_stats;
+            Stats* m_outer = nullptr;
+#endif
+        };
+    } // namespace detail
+} // namespace nbt
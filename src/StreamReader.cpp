@@ -1,44 +1,103 @@
 #include "StreamReader.hpp"
 
 #include <cstring>
+#include <stdexcept>
+
+#include "Stats.hpp"
 
 namespace nbt {
-    StreamReader::StreamReader(std::span<uint8_t> data) : m_data(data.data()), m_len(data.size()) {}
+    template <Encoding E>
+    BasicStreamReader<E>::BasicStreamReader(std::span<uint8_t> data) : m_begin(data.data()), m_data(data.data()), m_len(data.size()) {}
+
+    template <Encoding E>
+    BasicStreamReader<E>::BasicStreamReader(StreamSource& source) : m_begin(nullptr), m_data(nullptr), m_len(0), m_source(&source) {}
+
+    template <Encoding E>
+    bool BasicStreamReader<E>::refill(size_t need) {
+        if (!m_source)
+            return false;
+
+        detail::PhaseTimer timer(Phase::Inflate);
+        m_consumed += m_data - m_begin;
+        auto window = m_source->refill(m_data, m_len, need);
+        m_begin = m_data = window.data();
+        m_len = window.size();
+        return m_len >= need;
+    }
 
-    void StreamReader::read(std::span<uint8_t> data) {
+    template <Encoding E>
+    void BasicStreamReader<E>::underflow(size_t need) const {
+        if (m_source)
+            throw std::runtime_error(std::format("Unexpected end of the stream (needed {} bytes, only {} left)", need, m_len));
+        throw std::runtime_error(
+            std::format("Unexpected end of data at offset {} (needed {} bytes, only {} left)", offset(), need, m_len));
+    }
+
+    template <Encoding E>
+    void BasicStreamReader<E>::badVarint() const {
+        if (m_source)
+            throw std::runtime_error("Malformed varint in the stream");
+        throw std::runtime_error(std::format("Malformed varint at offset {}", offset()));
+    }
+
+    template <Encoding E>
+    bool BasicStreamReader<E>::read(std::span<uint8_t> data) {
         auto len = data.size();
-        if (m_len < len) {
-            std::cerr << std::format("[nbtpp] Failed to read {} bytes from the buffer (only {} left)!", len, m_len) << std::endl;
-            return;
+        if (m_len < len && !m_source)
+            return false;
+
+        // a streaming reader copies whatever is buffered and refills until done
+        auto dst = data.data();
+        while (len) {
+            if (!m_len && !refill(1))
+                return false;
+
+            auto chunk = std::min(len, m_len);
+            memcpy(dst, m_data, chunk);
+            dst += chunk;
+            len -= chunk;
+            m_len -= chunk;
+            m_data += chunk;
         }
+        return true;
+    }
 
-        memcpy(data.data(), m_data, len);
-        m_len -= len;
-        m_data += len;
+    template <Encoding E>
+    std::string BasicStreamReader<E>::readStr() {
+        return std::string(readStrView());
     }
 
-    std::string StreamReader::readStr() {
+    template <Encoding E>
+    std::string_view BasicStreamReader<E>::readStrView() {
         auto len = read<uint16_t>();
+        if (m_len < len && !refill(len))
+            underflow(len);
 
-        if (len == 0) {
-            return "";
-        }
-
-        auto bytes = new char[len + 1];
-        bytes[len] = 0;
-        read({(uint8_t*)bytes, len});
-        auto str = std::string(bytes, len);
-        delete[] bytes;
+        auto str = std::string_view((const char*)m_data, len);
+        m_len -= len;
+        m_data += len;
         return str;
     }
 
-    void StreamReader::skip(size_t len) {
-        if (len > m_len) {
-            std::cerr << std::format("[nbtpp] Failed to skip {} bytes (only {} left)!", len, m_len) << std::endl;
-            return;
+    template <Encoding E>
+    bool BasicStreamReader<E>::skip(size_t len) {
+        while (len > m_len) {
+            if (!m_source)
+                return false;
+
+            len -= m_len;
+            m_data += m_len;
+            m_len = 0;
+            if (!refill(1))
+                return false;
         }
 
         m_len -= len;
         m_data += len;
+        return true;
     }
+
+    template class BasicStreamReader<Encoding::Java>;
+    template class BasicStreamReader<Encoding::Bedrock>;
+    template class BasicStreamReader<Encoding::Network>;
 } // namespace nbt
\ No newline at end of file
@@ -2,28 +2,42 @@
 #include <cstdint>
 #include <span>
 #include <algorithm>
-#include <iostream>
 #include <format>
+#include <string>
+#include <string_view>
+#include <cstring>
+
+#include "StreamSource.hpp"
+#include "ByteSwap.hpp"
+#include "Encoding.hpp"
 
 namespace nbt {
-    class StreamReader {
+    // Reads values laid out in the encoding E. Fixed-width values are a copy plus (when the byte order differs from
+    // the host's) a swap, varints are decoded a byte at a time.
+    template <Encoding E>
+    class BasicStreamReader {
       public:
-        StreamReader(std::span<uint8_t> data);
+        static constexpr Encoding encoding = E;
+
+        BasicStreamReader(std::span<uint8_t> data);
+        // pulls the data from the source as it goes, such a reader must not be copied
+        BasicStreamReader(StreamSource& source);
 
+        // throws std::runtime_error when the data ends first
         template <typename T>
-        StreamReader& operator>>(T& other) {
-            constexpr auto size = sizeof(other);
-            if (m_len < size) {
-                std::cerr << std::format("[nbtpp] Failed to read {} bytes from the buffer (only {} left)!", size, m_len)
-                          << std::endl;
-                return *this;
-            }
+        BasicStreamReader& operator>>(T& other) {
+            if constexpr (isVarint<E, T>) {
+                other = readVarint<T, true>();
+            } else {
+                constexpr auto size = sizeof(other);
+                if (m_len < size && !refill(size)) [[unlikely]]
+                    underflow(size);
 
-            other = *((T*)m_data);
-            if constexpr (size > 1 && std::endian::native == std::endian::little)
-                std::reverse((uint8_t*)&other, (uint8_t*)&other + size);
-            m_len -= size;
-            m_data += size;
+                memcpy(&other, m_data, size);
+                other = convertOrder<E>(other);
+                m_len -= size;
+                m_data += size;
+            }
 
             return *this;
         }
@@ -35,13 +49,126 @@ namespace nbt {
             return val;
         }
 
+        // Reads without any bounds check, only for a buffer which has been proven well-formed (see validate). A
+        // streaming reader must not use these.
+        template <typename T>
+        T readUnchecked() {
+            if constexpr (isVarint<E, T>) {
+                return readVarint<T, false>();
+            } else {
+                T val;
+                memcpy(&val, m_data, sizeof(T));
+                m_len -= sizeof(T);
+                m_data += sizeof(T);
+                return convertOrder<E>(val);
+            }
+        }
+        template <typename T>
+        void readArrayUnchecked(std::span<T> data) {
+            if constexpr (isVarint<E, T>) {
+                for (auto& item : data)
+                    item = readVarint<T, false>();
+            } else {
+                memcpy(data.data(), m_data, data.size_bytes());
+                m_len -= data.size_bytes();
+                m_data += data.size_bytes();
+                convertOrderArray<E>(data.data(), data.size());
+            }
+        }
+        inline std::string_view readStrViewUnchecked() {
+            auto len = readUnchecked<uint16_t>();
+            auto str = std::string_view((const char*)m_data, len);
+            m_len -= len;
+            m_data += len;
+            return str;
+        }
+
+        // number of bytes buffered right now, for a streaming reader more may follow
         inline size_t len() const { return m_len; }
-        void read(std::span<uint8_t> data);
+        // the part of the buffer which has not been read yet
+        inline std::span<uint8_t> remaining() const { return {m_data, m_len}; }
+        // makes sure at least `len` contiguous bytes are buffered (limited by the source window), false if the data ends first
+        inline bool ensure(size_t len) { return m_len >= len || refill(len); }
+        inline bool isStreaming() const { return m_source; }
+        // set when the buffer outlives everything read from it, compounds and lists then remember the payload they
+        // were read from (see loadForEditing, Java only)
+        inline bool tracksSource() const { return m_trackSource; }
+        inline void setTrackSource(bool track) { m_trackSource = track && !m_source; }
+
+        // false when the data ends first, what was read up to there is consumed
+        bool read(std::span<uint8_t> data);
+        // Reads a whole array with a single copy and, when the byte order differs from the host's, a vectorized byte
+        // swap. Varint arrays are decoded item by item and throw when the data ends first.
+        template <typename T>
+        bool readArray(std::span<T> data) {
+            if constexpr (isVarint<E, T>) {
+                for (auto& item : data)
+                    item = readVarint<T, true>();
+            } else {
+                if (!read({(uint8_t*)data.data(), data.size_bytes()}))
+                    return false;
+                convertOrderArray<E>(data.data(), data.size());
+            }
+            return true;
+        }
+        // throws std::runtime_error when the data ends first, like operator>>
         std::string readStr();
-        void skip(size_t len);
+        // the view points into the underlying buffer and is only valid as long as it is (for a streaming reader,
+        // until the next read)
+        std::string_view readStrView();
+        // false when the data ends first, like read
+        bool skip(size_t len);
+
+        // position in the buffer the reader was created with, for a streaming reader the position in the current window
+        inline size_t offset() const { return m_data - m_begin; }
+        // bytes read so far, across every window of a streaming reader
+        inline uint64_t consumed() const { return m_consumed + (m_data - m_begin); }
 
       private:
+        template <typename T, bool Checked>
+        T readVarint() {
+            uint64_t raw = 0;
+            for (size_t i = 0;; i++) {
+                if constexpr (Checked) {
+                    if (!m_len && !refill(1)) [[unlikely]]
+                        underflow(1);
+                }
+
+                auto byte = *m_data++;
+                m_len--;
+                raw |= uint64_t(byte & 0x7F) << (7 * i);
+                if (!(byte & 0x80))
+                    break;
+                if constexpr (Checked) {
+                    if (i + 1 == maxVarintSize<T>()) [[unlikely]]
+                        badVarint();
+                }
+            }
+
+            if constexpr (Checked && sizeof(T) == 2) {
+                if (raw > 0xFFFF) [[unlikely]]
+                    badVarint();
+            }
+            return fromVarint<T>(raw);
+        }
+
+        bool refill(size_t need);
+        [[noreturn]] void underflow(size_t need) const;
+        [[noreturn]] void badVarint() const;
+
+        uint8_t* m_begin;
         uint8_t* m_data;
         size_t m_len;
+        uint64_t m_consumed = 0;
+        StreamSource* m_source = nullptr;
+        bool m_trackSource = false;
     };
-} // namespace nbt
\ No newline at end of file
+
+    using StreamReader = BasicStreamReader<Encoding::Java>;
+    using BedrockStreamReader = BasicStreamReader<Encoding::Bedrock>;
+    using NetworkStreamReader = BasicStreamReader<Encoding::Network>;
+
+    extern template class BasicStreamReader<Encoding::Java>;
+    extern template class BasicStreamReader<Encoding::Bedrock>;
+    extern template class BasicStreamReader<Encoding::Network>;
+} // namespace nbt
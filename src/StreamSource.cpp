@@ -0,0 +1,102 @@
+#include "StreamSource.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+namespace nbt {
+    StreamSource::StreamSource(size_t windowSize) : m_window(windowSize) {}
+
+    std::span<uint8_t> StreamSource::refill(const uint8_t* unread, size_t len, size_t need) {
+        need = std::min(need, m_window.size());
+        if (len && unread != m_window.data())
+            memmove(m_window.data(), unread, len);
+
+        while (len < need) {
+            auto produced = produce({m_window.data() + len, m_window.size() - len});
+            if (!produced)
+                break;
+            len += produced;
+        }
+
+        return {m_window.data(), len};
+    }
+
+    AsyncSource::AsyncSource(std::unique_ptr<StreamSource> inner, size_t blockSize, size_t blockCount)
+        : m_inner(std::move(inner)), m_blocks(std::max<size_t>(blockCount, 1)) {
+        for (auto& block : m_blocks)
+            block.data.resize(blockSize);
+        m_thread = std::thread(&AsyncSource::run, this);
+    }
+
+    AsyncSource::~AsyncSource() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stopping = true;
+        }
+        m_cv.notify_all();
+        m_thread.join();
+    }
+
+    void AsyncSource::run() {
+        size_t writeIndex = 0;
+        while (true) {
+            auto& block = m_blocks[writeIndex];
+            {
+                std::unique_lock lock(m_mutex);
+                m_cv.wait(lock, [&] { return !block.filled || m_stopping; });
+                if (m_stopping)
+                    return;
+            }
+
+            size_t size = 0;
+            try {
+                size = m_inner->produce(block.data);
+            } catch (...) {
+                std::lock_guard lock(m_mutex);
+                m_error = std::current_exception();
+            }
+
+            {
+                std::lock_guard lock(m_mutex);
+                block.size = size;
+                block.offset = 0;
+                block.filled = true;
+            }
+            m_cv.notify_all();
+
+            if (!size)
+                return;
+            writeIndex = (writeIndex + 1) % m_blocks.size();
+        }
+    }
+
+    size_t AsyncSource::produce(std::span<uint8_t> dst) {
+        size_t written = 0;
+        while (written < dst.size()) {
+            auto& block = m_blocks[m_readIndex];
+            {
+                std::unique_lock lock(m_mutex);
+                m_cv.wait(lock, [&] { return block.filled; });
+                if (m_error)
+                    std::rethrow_exception(m_error);
+                if (!block.size)
+                    break; // end of the stream, leave the block marked as filled so later calls return 0 too
+            }
+
+            auto len = std::min(dst.size() - written, block.size - block.offset);
+            memcpy(dst.data() + written, block.data.data() + block.offset, len);
+            block.offset += len;
+            written += len;
+
+            if (block.offset == block.size) {
+                {
+                    std::lock_guard lock(m_mutex);
+                    block.filled = false;
+                }
+                m_cv.notify_all();
+                m_readIndex = (m_readIndex + 1) % m_blocks.size();
+            }
+        }
+        return written;
+    }
+} // namespace nbt
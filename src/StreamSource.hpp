@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+namespace nbt {
+    // Supplies bytes to a StreamReader in pieces, so the whole input never has to be in memory at once.
+    // The source owns a fixed window which the reader parses from directly.
+    class StreamSource {
+      public:
+        StreamSource(size_t windowSize = 128 * 1024);
+        virtual ~StreamSource() {}
+
+        // writes the next bytes of the stream into dst, returns how many were written (0 at the end of the stream)
+        virtual size_t produce(std::span<uint8_t> dst) = 0;
+
+        // moves the unread bytes to the start of the window and appends new ones until at least `need` bytes
+        // are available or the stream ends, returns the unread part of the window
+        std::span<uint8_t> refill(const uint8_t* unread, size_t len, size_t need);
+
+        inline size_t windowSize() const { return m_window.size(); }
+
+      private:
+        std::vector<uint8_t> m_window;
+    };
+
+    // Runs another source on a background thread and hands its output over through a few fixed blocks,
+    // so producing (e.g. inflating) the next block overlaps with parsing the current one.
+    class AsyncSource : public StreamSource {
+      public:
+        AsyncSource(std::unique_ptr<StreamSource> inner, size_t blockSize = 64 * 1024, size_t blockCount = 2);
+        ~AsyncSource() override;
+
+        size_t produce(std::span<uint8_t> dst) override;
+
+      private:
+        struct Block {
+            std::vector<uint8_t> data;
+            size_t size = 0;
+            size_t offset = 0;
+            bool filled = false;
+        };
+
+        void run();
+
+        std::unique_ptr<StreamSource> m_inner;
+        std::vector<Block> m_blocks;
+        size_t m_readIndex = 0;
+        bool m_stopping = false;
+        std::exception_ptr m_error;
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::thread m_thread;
+    };
+} // namespace nbt
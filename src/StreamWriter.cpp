@@ -1,21 +1,89 @@
 #include "StreamWriter.hpp"
 
+#include <format>
+#include <stdexcept>
+
 namespace nbt {
-    void StreamWriter::writeRaw(std::vector<uint8_t> bytes) {
-        m_bytes.insert(m_bytes.end(), bytes.begin(), bytes.end());
+    template <Encoding E>
+    BasicStreamWriter<E>::BasicStreamWriter(std::span<uint8_t> buffer)
+        : m_begin(buffer.data()), m_cur(buffer.data()), m_end(buffer.data() + buffer.size()), m_external(true) {}
+
+    template <Encoding E>
+    void BasicStreamWriter<E>::grow(size_t len) {
+        if (m_external) {
+            throw std::runtime_error(
+                std::format("Failed to write {} bytes into the buffer (only {} left)", len, static_cast<size_t>(m_end - m_cur)));
+        }
+
+        auto written = size();
+        if (m_bytes.capacity() - written < len)
+            m_bytes.reserve(std::max(written + len, m_bytes.capacity() * 2));
+        // zero-filling a step at a time keeps it in the cache the following writes go to
+        m_bytes.resize(std::max(written + len, std::min(written + FillStep, m_bytes.capacity())));
+        m_begin = m_bytes.data();
+        m_cur = m_begin + written;
+        m_end = m_begin + m_bytes.size();
+    }
+
+    template <Encoding E>
+    void BasicStreamWriter<E>::reserve(size_t len) {
+        if (static_cast<size_t>(m_end - m_cur) >= len)
+            return;
+
+        if (m_external)
+            grow(len);
+
+        // only the capacity, grow() resizes into it as the writes get there
+        auto written = size();
+        m_bytes.resize(written);
+        m_bytes.reserve(std::max<size_t>(written + len, 64));
+        m_begin = m_bytes.data();
+        m_cur = m_begin + written;
+        m_end = m_begin + m_bytes.size();
     }
 
-    void StreamWriter::writeRaw(std::initializer_list<uint8_t> bytes) {
-        m_bytes.insert(m_bytes.end(), bytes);
+    template <Encoding E>
+    const std::vector<uint8_t>& BasicStreamWriter<E>::getBytes() {
+        if (!m_external) {
+            // shrinking never reallocates, the pointers stay valid
+            m_bytes.resize(size());
+            m_end = m_cur;
+        }
+        return m_bytes;
     }
 
-    void StreamWriter::writeRaw(std::span<uint8_t> data) {
-        m_bytes.insert(m_bytes.end(), data.begin(), data.end());
+    template <Encoding E>
+    std::vector<uint8_t> BasicStreamWriter<E>::takeBytes() {
+        getBytes();
+        auto bytes = std::move(m_bytes);
+        m_bytes = {};
+        m_begin = m_cur = m_end = nullptr;
+        return bytes;
     }
 
-    void StreamWriter::writeStr(const std::string& str) {
+    template <Encoding E>
+    void BasicStreamWriter<E>::writeRaw(std::vector<uint8_t> bytes) {
+        put(bytes.data(), bytes.size());
+    }
+
+    template <Encoding E>
+    void BasicStreamWriter<E>::writeRaw(std::initializer_list<uint8_t> bytes) {
+        put(bytes.begin(), bytes.size());
+    }
+
+    template <Encoding E>
+    void BasicStreamWriter<E>::writeRaw(std::span<const uint8_t> data) {
+        put(data.data(), data.size());
+    }
+
+    template <Encoding E>
+    void BasicStreamWriter<E>::writeStr(std::string_view str) {
         auto len = static_cast<uint16_t>(str.length());
         write(len);
-        writeRaw({(uint8_t*)str.c_str(), len});
+        put(str.data(), len);
     }
+
+    template class BasicStreamWriter<Encoding::Java>;
+    template class BasicStreamWriter<Encoding::Bedrock>;
+    template class BasicStreamWriter<Encoding::Network>;
 } // namespace nbt
\ No newline at end of file
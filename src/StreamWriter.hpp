@@ -2,38 +2,107 @@
 #include <cstdint>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <span>
 #include <algorithm>
+#include <cstring>
+
+#include "ByteSwap.hpp"
+#include "Encoding.hpp"
 
 namespace nbt {
-    class StreamWriter {
+    // Writes values laid out in the encoding E, see BasicStreamReader.
+    template <Encoding E>
+    class BasicStreamWriter {
       public:
+        static constexpr Encoding encoding = E;
+
+        // writes into an internal buffer which grows as needed
+        BasicStreamWriter() {}
+        // writes into a caller-provided buffer, running out of space throws
+        BasicStreamWriter(std::span<uint8_t> buffer);
+        BasicStreamWriter(const BasicStreamWriter& other) = delete;
+        BasicStreamWriter& operator=(const BasicStreamWriter& other) = delete;
+
         template <typename T>
         void write(T val) {
-            constexpr auto len = sizeof(T);
-            auto start = (uint8_t*)&val;
-            auto end = start + len;
-            if constexpr (len > 1 && std::endian::native == std::endian::little) {
-                std::reverse(start, end);
+            if constexpr (isVarint<E, T>) {
+                uint8_t bytes[maxVarintSize<T>()];
+                put(bytes, toVarint(val, bytes));
+            } else {
+                val = convertOrder<E>(val);
+                put(&val, sizeof(T));
+            }
+        }
+
+        // Writes a whole array with a single copy and, when the byte order differs from the host's, a vectorized
+        // byte swap. Varint arrays are encoded item by item.
+        template <typename T>
+        void writeArray(std::span<const T> data) {
+            if constexpr (isVarint<E, T>) {
+                for (auto item : data)
+                    write(item);
+            } else {
+                put(data.data(), data.size_bytes());
+                if constexpr (sizeof(T) > 1 && byteOrder(E) != std::endian::native) {
+                    // put() may have reallocated the buffer
+                    auto start = m_cur - data.size_bytes();
+                    swapBytesInPlace(start, data.size(), sizeof(T));
+                }
             }
-            m_bytes.insert(m_bytes.end(), start, end);
         }
 
         void writeRaw(std::vector<uint8_t> bytes);
         void writeRaw(std::initializer_list<uint8_t> bytes);
-        void writeRaw(std::span<uint8_t> data);
-        void writeStr(const std::string& str);
+        void writeRaw(std::span<const uint8_t> data);
+        void writeStr(std::string_view str);
 
-        inline const std::vector<uint8_t>& getBytes() const { return m_bytes; }
-        inline void clear() { m_bytes.clear(); }
+        // makes room for `len` more bytes up front, so the following writes never reallocate
+        void reserve(size_t len);
+        inline size_t size() const { return m_cur - m_begin; }
+        // the bytes written so far, works for both buffer kinds
+        inline std::span<const uint8_t> written() const { return {m_begin, size()}; }
+
+        // only for the internal buffer
+        const std::vector<uint8_t>& getBytes();
+        // moves the internal buffer out without copying, the writer is empty afterwards
+        std::vector<uint8_t> takeBytes();
+        inline void clear() { m_cur = m_begin; }
 
         template <typename T>
-        StreamWriter& operator<<(T val) {
+        BasicStreamWriter& operator<<(T val) {
             write(val);
             return *this;
         }
 
       private:
+        inline void put(const void* data, size_t len) {
+            // the data of an empty array or list may be null
+            if (len == 0)
+                return;
+            if (static_cast<size_t>(m_end - m_cur) < len)
+                grow(len);
+            memcpy(m_cur, data, len);
+            m_cur += len;
+        }
+
+        void grow(size_t len);
+
+        // the written part of m_bytes is [m_begin, m_cur), it is only resized (so zero-filled) a few KiB ahead of
+        // the writes, the space reserved beyond that is left untouched
+        static constexpr size_t FillStep = 4096;
         std::vector<uint8_t> m_bytes;
+        uint8_t* m_begin = nullptr;
+        uint8_t* m_cur = nullptr;
+        uint8_t* m_end = nullptr;
+        bool m_external = false;
     };
+
+    using StreamWriter = BasicStreamWriter<Encoding::Java>;
+    using BedrockStreamWriter = BasicStreamWriter<Encoding::Bedrock>;
+    using NetworkStreamWriter = BasicStreamWriter<Encoding::Network>;
+
+    extern template class BasicStreamWriter<Encoding::Java>;
+    extern template class BasicStreamWriter<Encoding::Bedrock>;
+    extern template class BasicStreamWriter<Encoding::Network>;
 } // namespace nbt
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "Tags.hpp"
+
+#include <stdexcept>
+
+namespace nbt {
+    template <Encoding E>
+    void ensureAvailable(BasicStreamReader<E>& reader, size_t len) {
+        if (!reader.ensure(len))
+            throw std::runtime_error(std::format("Unexpected end of data (needed {} bytes, only {} left)", len, reader.len()));
+    }
+
+    template <Encoding E>
+    void checkedRead(BasicStreamReader<E>& reader, std::span<uint8_t> data) {
+        if (!reader.isStreaming())
+            ensureAvailable(reader, data.size());
+        if (!reader.read(data))
+            throw std::runtime_error("Unexpected end of data");
+    }
+
+    template <Encoding E>
+    void checkedSkip(BasicStreamReader<E>& reader, size_t len) {
+        if (!reader.isStreaming())
+            ensureAvailable(reader, len);
+        if (!reader.skip(len))
+            throw std::runtime_error("Unexpected end of data");
+    }
+
+    template <Encoding E>
+    void skipListItems(BasicStreamReader<E>& reader, TagID itemsID, size_t len, size_t depth) {
+        if (auto size = fixedPayloadSize(itemsID, E)) {
+            checkedSkip(reader, len * size);
+        } else {
+            for (size_t i = 0; i < len; i++)
+                skipPayload(reader, itemsID, depth);
+        }
+    }
+
+    template <Encoding E>
+    void skipPayload(BasicStreamReader<E>& reader, TagID id, size_t depth) {
+        if (auto size = fixedPayloadSize(id, E)) {
+            checkedSkip(reader, size);
+            return;
+        }
+        // the recursion below must not run out of stack on hostile input
+        if ((id == TagID::List || id == TagID::Compound) && depth >= MaxDepth)
+            throw std::runtime_error(std::format("Nesting deeper than {}", MaxDepth));
+
+        switch (id) {
+        case TagID::Int: {
+            checkedRead<int>(reader); // a varint
+        } break;
+        case TagID::Long: {
+            checkedRead<long long>(reader);
+        } break;
+        case TagID::String: {
+            checkedSkip(reader, checkedRead<uint16_t>(reader));
+        } break;
+        case TagID::ByteArray: {
+            checkedSkip(reader, checkedRead<uint32_t>(reader));
+        } break;
+        case TagID::IntArray: {
+            skipListItems(reader, TagID::Int, checkedRead<uint32_t>(reader));
+        } break;
+        case TagID::LongArray: {
+            skipListItems(reader, TagID::Long, checkedRead<uint32_t>(reader));
+        } break;
+        case TagID::List: {
+            auto itemsID = checkedRead<TagID>(reader);
+            auto len = checkedRead<uint32_t>(reader);
+            skipListItems(reader, itemsID, len, depth + 1);
+        } break;
+        case TagID::Compound: {
+            while (true) {
+                auto tag = checkedRead<TagID>(reader);
+                if (tag == TagID::End)
+                    break;
+
+                checkedSkip(reader, checkedRead<uint16_t>(reader));
+                skipPayload(reader, tag, depth + 1);
+            }
+        } break;
+        default: {
+            throw std::runtime_error(std::format("Invalid tag {} while skipping", static_cast<int>(id)));
+        } break;
+        }
+    }
+
+    template void ensureAvailable(BasicStreamReader<Encoding::Java>&, size_t);
+    template void checkedRead(BasicStreamReader<Encoding::Java>&, std::span<uint8_t>);
+    template void checkedSkip(BasicStreamReader<Encoding::Java>&, size_t);
+    template void skipPayload(BasicStreamReader<Encoding::Java>&, TagID, size_t);
+    template void skipListItems(BasicStreamReader<Encoding::Java>&, TagID, size_t, size_t);
+
+    template void ensureAvailable(BasicStreamReader<Encoding::Bedrock>&, size_t);
+    template void checkedRead(BasicStreamReader<Encoding::Bedrock>&, std::span<uint8_t>);
+    template void checkedSkip(BasicStreamReader<Encoding::Bedrock>&, size_t);
+    template void skipPayload(BasicStreamReader<Encoding::Bedrock>&, TagID, size_t);
+    template void skipListItems(BasicStreamReader<Encoding::Bedrock>&, TagID, size_t, size_t);
+
+    template void ensureAvailable(BasicStreamReader<Encoding::Network>&, size_t);
+    template void checkedRead(BasicStreamReader<Encoding::Network>&, std::span<uint8_t>);
+    template void checkedSkip(BasicStreamReader<Encoding::Network>&, size_t);
+    template void skipPayload(BasicStreamReader<Encoding::Network>&, TagID, size_t);
+    template void skipListItems(BasicStreamReader<Encoding::Network>&, TagID, size_t, size_t);
+} // namespace nbt
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+#include "StreamReader.hpp"
+
+namespace nbt {
+    enum class TagID : uint8_t {
+        End = 0,
+        Byte,
+        Short,
+        Int,
+        Long,
+        Float,
+        Double,
+        ByteArray,
+        String,
+        List,
+        Compound,
+        IntArray,
+        LongArray,
+        None = 0xFF // custom
+    };
+
+    // deepest nesting of compounds and lists the loaders accept, the same limit the game uses
+    constexpr size_t MaxDepth = 512;
+
+    // size of the payload of a fixed-size tag, 0 for tags with a variable size (Int and Long are varints in the
+    // network encoding)
+    constexpr size_t fixedPayloadSize(TagID id, Encoding encoding = Encoding::Java) {
+        switch (id) {
+        case TagID::Byte:
+            return 1;
+        case TagID::Short:
+            return 2;
+        case TagID::Int:
+            return encoding == Encoding::Network ? 0 : 4;
+        case TagID::Float:
+            return 4;
+        case TagID::Long:
+            return encoding == Encoding::Network ? 0 : 8;
+        case TagID::Double:
+            return 8;
+        default:
+            return 0;
+        }
+    }
+
+    // tag of a numeric payload type (char, short, int, long long, float or double), None for anything else
+    template <typename T>
+    constexpr TagID scalarTagID() {
+        return std::is_same_v<T, char>        ? TagID::Byte
+               : std::is_same_v<T, short>     ? TagID::Short
+               : std::is_same_v<T, int>       ? TagID::Int
+               : std::is_same_v<T, long long> ? TagID::Long
+               : std::is_same_v<T, float>     ? TagID::Float
+               : std::is_same_v<T, double>    ? TagID::Double
+                                              : TagID::None;
+    }
+
+    // throws unless `len` contiguous bytes can be buffered in the reader
+    template <Encoding E>
+    void ensureAvailable(BasicStreamReader<E>& reader, size_t len);
+
+    template <typename T, Encoding E>
+    T checkedRead(BasicStreamReader<E>& reader) {
+        ensureAvailable(reader, minEncodedSize<E, T>());
+        return reader.template read<T>();
+    }
+
+    // like StreamReader::read and StreamReader::skip but throw on malformed data, streaming readers are fine too
+    template <Encoding E>
+    void checkedRead(BasicStreamReader<E>& reader, std::span<uint8_t> data);
+    template <Encoding E>
+    void checkedSkip(BasicStreamReader<E>& reader, size_t len);
+
+    // Moves the reader past the payload of a tag without decoding it, throws on malformed data and on containers
+    // nested deeper than MaxDepth. `depth` is the nesting of the tag when the caller is already inside a tree.
+    template <Encoding E>
+    void skipPayload(BasicStreamReader<E>& reader, TagID id, size_t depth = 0);
+    // skips `len` list items of the given tag, i.e. the rest of a list payload after its header (or the items of
+    // an array, with the tag of a single item); `depth` is the one of the items
+    template <Encoding E>
+    void skipListItems(BasicStreamReader<E>& reader, TagID itemsID, size_t len, size_t depth = 0);
+} // namespace nbt
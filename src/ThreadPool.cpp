@@ -0,0 +1,64 @@
+#include "ThreadPool.hpp"
+
+namespace nbt {
+    ThreadPool::ThreadPool(size_t threads) {
+        if (!threads)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+        m_workers.reserve(threads);
+        for (size_t i = 0; i < threads; i++)
+            m_workers.emplace_back(&ThreadPool::run, this);
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stopping = true;
+        }
+        m_cv.notify_all();
+        for (auto& worker : m_workers)
+            worker.join();
+    }
+
+    void ThreadPool::submit(std::function<void()> task) {
+        {
+            std::lock_guard lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_cv.notify_one();
+    }
+
+    void ThreadPool::run() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(m_mutex);
+                m_cv.wait(lock, [&] { return m_stopping || !m_tasks.empty(); });
+                if (m_tasks.empty())
+                    return;
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    ThreadPool& ThreadPool::shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    void ByteBudget::acquire(size_t bytes) {
+        std::unique_lock lock(m_mutex);
+        m_cv.wait(lock, [&] { return m_used == 0 || m_used + bytes <= m_limit; });
+        m_used += bytes;
+    }
+
+    void ByteBudget::release(size_t bytes) {
+        {
+            std::lock_guard lock(m_mutex);
+            m_used -= bytes;
+        }
+        m_cv.notify_all();
+    }
+} // namespace nbt
@@ -0,0 +1,123 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace nbt {
+    // Fixed set of worker threads running queued tasks.
+    class ThreadPool {
+      public:
+        // 0 means one thread per hardware core
+        ThreadPool(size_t threads = 0);
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        ~ThreadPool();
+
+        inline size_t size() const { return m_workers.size(); }
+
+        void submit(std::function<void()> task);
+
+        // Calls fn(slot, i) for every i in [0, count) using up to `size() + 1` slots (the calling thread helps too),
+        // or maxSlots if that is lower and not 0. Idle slots claim the next item, so uneven items still balance.
+        // Every slot runs on one thread at a time, so per-slot state needs no locking. The first exception thrown
+        // is rethrown once all items are done.
+        // The caller only waits for the helpers which started before it ran out of items, the others do nothing
+        // when they get to run. So it can be called from a task of the same pool (e.g. saveToBytesParallel from
+        // an AsyncSaver job) even when every worker is busy: the items then all run on the calling thread.
+        template <typename F>
+        void parallelFor(size_t count, F&& fn, size_t maxSlots = 0) {
+            if (!count)
+                return;
+
+            auto slots = std::min(count, size() + 1);
+            if (maxSlots)
+                slots = std::min(slots, maxSlots);
+            std::atomic<size_t> next = 0;
+            std::exception_ptr error;
+            std::mutex errorMutex;
+
+            auto work = [&](size_t slot) {
+                for (auto i = next++; i < count; i = next++) {
+                    try {
+                        fn(slot, i);
+                    } catch (...) {
+                        std::lock_guard lock(errorMutex);
+                        if (!error)
+                            error = std::current_exception();
+                    }
+                }
+            };
+
+            // outlives the call, a helper may start long after the items are done
+            struct Helpers {
+                std::mutex mutex;
+                std::condition_variable done;
+                size_t running = 0;
+                bool finished = false;
+            };
+            auto helpers = std::make_shared<Helpers>();
+            for (size_t slot = 1; slot < slots; slot++) {
+                submit([&, helpers, slot] {
+                    {
+                        std::lock_guard lock(helpers->mutex);
+                        if (helpers->finished)
+                            return;
+                        helpers->running++;
+                    }
+                    work(slot);
+                    // nothing on the caller's stack frame may be touched after the lock is released
+                    std::lock_guard lock(helpers->mutex);
+                    if (--helpers->running == 0)
+                        helpers->done.notify_all();
+                });
+            }
+
+            work(0);
+            {
+                std::unique_lock lock(helpers->mutex);
+                helpers->finished = true;
+                helpers->done.wait(lock, [&] { return helpers->running == 0; });
+            }
+
+            if (error)
+                std::rethrow_exception(error);
+        }
+
+        // shared pool used when no pool is passed explicitly
+        static ThreadPool& shared();
+
+      private:
+        void run();
+
+        std::vector<std::thread> m_workers;
+        std::deque<std::function<void()>> m_tasks;
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        bool m_stopping = false;
+    };
+
+    // Caps the bytes held by work in flight across threads. acquire blocks until the bytes fit next to what the
+    // others hold; an amount larger than the whole budget is let through once nothing else is held, so every
+    // acquire eventually returns as long as each one is released.
+    class ByteBudget {
+      public:
+        ByteBudget(size_t limit) : m_limit(limit) {}
+
+        void acquire(size_t bytes);
+        void release(size_t bytes);
+        inline size_t limit() const { return m_limit; }
+
+      private:
+        size_t m_limit;
+        size_t m_used = 0;
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+    };
+} // namespace nbt
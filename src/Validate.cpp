@@ -0,0 +1,217 @@
+#include "Validate.hpp"
+
+#include <cstring>
+
+namespace nbt {
+    namespace {
+        // a bounds-checked cursor which records the first error instead of throwing
+        template <Encoding E>
+        class Validator {
+          public:
+            Validator(std::span<const uint8_t> bytes, size_t maxDepth)
+                : m_begin(bytes.data()), m_data(bytes.data()), m_end(bytes.data() + bytes.size()), m_maxDepth(maxDepth) {}
+
+            bool root() {
+                auto start = m_data;
+                TagID tag;
+                if (!read(tag))
+                    return false;
+                if (tag != TagID::Compound)
+                    return fail(start, std::format("Root tag is {}, not a compound", static_cast<int>(tag)));
+                return string() && payload(TagID::Compound, 0);
+            }
+
+            bool payload(TagID id, size_t depth) {
+                if (auto size = fixedPayloadSize(id, E))
+                    return skip(size);
+
+                switch (id) {
+                case TagID::Int:
+                    return varint<int32_t>();
+                case TagID::Long:
+                    return varint<int64_t>();
+                case TagID::String:
+                    return string();
+                case TagID::ByteArray:
+                    return array<char>();
+                case TagID::IntArray:
+                    return array<int32_t>();
+                case TagID::LongArray:
+                    return array<int64_t>();
+                case TagID::List:
+                    return list(depth + 1);
+                case TagID::Compound:
+                    return compound(depth + 1);
+                default:
+                    return fail(m_data, std::format("Invalid tag {}", static_cast<int>(id)));
+                }
+            }
+
+            inline size_t consumed() const { return m_data - m_begin; }
+            inline const ParseError& error() const { return m_error; }
+
+          private:
+            bool compound(size_t depth) {
+                if (depth > m_maxDepth)
+                    return fail(m_data, std::format("Nesting deeper than {}", m_maxDepth));
+
+                while (true) {
+                    auto start = m_data;
+                    TagID tag;
+                    if (!read(tag))
+                        return false;
+                    if (tag == TagID::End)
+                        return true;
+                    if (!validTag(tag))
+                        return fail(start, std::format("Invalid tag {} in a compound", static_cast<int>(tag)));
+                    if (!string() || !payload(tag, depth))
+                        return false;
+                }
+            }
+
+            bool list(size_t depth) {
+                if (depth > m_maxDepth)
+                    return fail(m_data, std::format("Nesting deeper than {}", m_maxDepth));
+
+                auto start = m_data;
+                TagID itemsID;
+                int32_t len;
+                if (!read(itemsID) || !read(len))
+                    return false;
+                if (itemsID != TagID::End && !validTag(itemsID))
+                    return fail(start, std::format("Invalid list items tag {}", static_cast<int>(itemsID)));
+                if (len < 0)
+                    return fail(start + 1, std::format("Negative list length {}", len));
+                if (itemsID == TagID::End)
+                    return len == 0 || fail(start, std::format("List of End with {} items", len));
+
+                // fixed-size items are skipped in one go
+                if (auto size = fixedPayloadSize(itemsID, E))
+                    return skip(size_t(len) * size);
+                for (int32_t i = 0; i < len; i++) {
+                    if (!payload(itemsID, depth))
+                        return false;
+                }
+                return true;
+            }
+
+            template <typename T>
+            bool array() {
+                auto start = m_data;
+                int32_t len;
+                if (!read(len))
+                    return false;
+                if (len < 0)
+                    return fail(start, std::format("Negative array length {}", len));
+                if constexpr (isVarint<E, T>) {
+                    for (int32_t i = 0; i < len; i++) {
+                        if (!varint<T>())
+                            return false;
+                    }
+                    return true;
+                } else {
+                    return skip(size_t(len) * sizeof(T));
+                }
+            }
+
+            bool string() {
+                uint16_t len;
+                return read(len) && skip(len);
+            }
+
+            template <typename T>
+            bool read(T& val) {
+                if constexpr (isVarint<E, T>) {
+                    uint64_t raw;
+                    if (!varint<T>(&raw))
+                        return false;
+                    val = fromVarint<T>(raw);
+                    return true;
+                } else {
+                    if (size_t(m_end - m_data) < sizeof(T))
+                        return truncated(sizeof(T));
+                    memcpy(&val, m_data, sizeof(T));
+                    val = convertOrder<E>(val);
+                    m_data += sizeof(T);
+                    return true;
+                }
+            }
+
+            // a varint which ends within maxVarintSize bytes (and fits in 16 bits for a string length)
+            template <typename T>
+            bool varint(uint64_t* out = nullptr) {
+                auto start = m_data;
+                uint64_t raw = 0;
+                for (size_t i = 0;; i++) {
+                    if (m_data == m_end)
+                        return truncated(1);
+                    if (i == maxVarintSize<T>())
+                        return fail(start, "Varint is too long");
+
+                    auto byte = *m_data++;
+                    raw |= uint64_t(byte & 0x7F) << (7 * i);
+                    if (!(byte & 0x80))
+                        break;
+                }
+                if (sizeof(T) == 2 && raw > 0xFFFF)
+                    return fail(start, std::format("String length {} does not fit in 16 bits", raw));
+                if (out)
+                    *out = raw;
+                return true;
+            }
+
+            bool skip(size_t len) {
+                if (size_t(m_end - m_data) < len)
+                    return truncated(len);
+                m_data += len;
+                return true;
+            }
+
+            static bool validTag(TagID id) { return id >= TagID::Byte && id <= TagID::LongArray; }
+
+            bool truncated(size_t need) {
+                return fail(m_data, std::format("Unexpected end of data (needed {} bytes, only {} left)", need, m_end - m_data));
+            }
+
+            bool fail(const uint8_t* at, std::string message) {
+                m_error = {size_t(at - m_begin), std::move(message)};
+                return false;
+            }
+
+            const uint8_t* m_begin;
+            const uint8_t* m_data;
+            const uint8_t* m_end;
+            size_t m_maxDepth;
+            ParseError m_error;
+        };
+    } // namespace
+
+    template <Encoding E>
+    static std::expected<size_t, ParseError> validateAs(std::span<const uint8_t> bytes, TagID id, size_t maxDepth) {
+        auto v = Validator<E>(bytes, maxDepth);
+        // None stands for a whole root
+        if (!(id == TagID::None ? v.root() : v.payload(id, 0)))
+            return std::unexpected(v.error());
+        return v.consumed();
+    }
+
+    static std::expected<size_t, ParseError> validateAs(std::span<const uint8_t> bytes, TagID id, Encoding encoding, size_t maxDepth) {
+        return visitEncoding(encoding, [&](auto e) { return validateAs<e.value>(bytes, id, maxDepth); });
+    }
+
+    std::expected<size_t, ParseError> validate(std::span<const uint8_t> bytes, size_t maxDepth) {
+        return validateAs(bytes, TagID::None, Encoding::Java, maxDepth);
+    }
+
+    std::expected<size_t, ParseError> validate(std::span<const uint8_t> bytes, Encoding encoding, size_t maxDepth) {
+        return validateAs(bytes, TagID::None, encoding, maxDepth);
+    }
+
+    std::expected<size_t, ParseError> validatePayload(std::span<const uint8_t> bytes, TagID id, size_t maxDepth) {
+        return validateAs(bytes, id, Encoding::Java, maxDepth);
+    }
+
+    std::expected<size_t, ParseError> validatePayload(std::span<const uint8_t> bytes, TagID id, Encoding encoding, size_t maxDepth) {
+        return validateAs(bytes, id, encoding, maxDepth);
+    }
+} // namespace nbt
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+#include <expected>
+
+#include "Tags.hpp"
+
+namespace nbt {
+    struct ParseError {
+        // position in the validated buffer where the malformed data starts
+        size_t offset;
+        std::string message;
+
+        inline std::string describe() const { return std::format("Malformed NBT at offset {}: {}", offset, message); }
+    };
+
+    // Walks a whole root compound (tag, name and payload) once without decoding anything and proves it is
+    // well-formed: every length fits in the buffer, every tag ID is known, lists of End are empty and nothing is
+    // nested deeper than maxDepth. Returns the size of the root, the buffer may continue after it.
+    // Data which passed can be decoded without any further checks, which is what loadFromBytes does.
+    std::expected<size_t, ParseError> validate(std::span<const uint8_t> bytes, size_t maxDepth = MaxDepth);
+    std::expected<size_t, ParseError> validate(std::span<const uint8_t> bytes, Encoding encoding, size_t maxDepth = MaxDepth);
+    // the same for the payload of a single tag
+    std::expected<size_t, ParseError> validatePayload(std::span<const uint8_t> bytes, TagID id, size_t maxDepth = MaxDepth);
+    std::expected<size_t, ParseError> validatePayload(std::span<const uint8_t> bytes, TagID id, Encoding encoding,
+                                                      size_t maxDepth = MaxDepth);
+} // namespace nbt
@@ -3,14 +3,46 @@
 #include <fstream>
 #include <format>
 #include <iostream>
-#ifdef nbtpp_zlib
-#include <zlib.h>
-#endif
+#include <algorithm>
+#include <typeinfo>
+
+#include "InflateSource.hpp"
+#include "MappedFile.hpp"
+#include "Compression.hpp"
+#include "AtomicFile.hpp"
 
 namespace nbt {
-    SimpleValue::SimpleValue(SimpleType value) : m_value(value) {}
+    SimpleValue::SimpleValue(SimpleType value, std::pmr::memory_resource* resource) : Value(resource), m_value(std::move(value)) {
+        // strings converted by the variant itself end up on the default resource
+        if (auto str = std::get_if<std::pmr::string>(&m_value); str && str->get_allocator().resource() != resource) {
+            auto copy = std::pmr::string(*str, resource);
+            m_value.emplace<std::pmr::string>(std::move(copy));
+        }
+    }
 
-    void SimpleValue::serialize(StreamWriter& writer) const {
+    void Value::release(Value* val) {
+        if (!val || val->isArenaOwned())
+            return;
+        if (val->m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete val;
+    }
+
+    Value* Value::clone() const {
+        throw std::runtime_error(std::format("Values of tag {} can not be cloned", static_cast<int>(getID())));
+    }
+
+    Value* SimpleValue::clone() const {
+        return makeValue<SimpleValue>(heapResource(), m_value);
+    }
+
+    SimpleValue::SimpleValue(const char* value, std::pmr::memory_resource* resource)
+        : SimpleValue(std::string_view(value), resource) {}
+
+    SimpleValue::SimpleValue(std::string_view value, std::pmr::memory_resource* resource)
+        : Value(resource), m_value(std::in_place_type<std::pmr::string>, value, resource) {}
+
+    template <Encoding E>
+    void SimpleValue::encode(BasicStreamWriter<E>& writer) const {
         auto id = getID();
         switch (id) {
         case TagID::Byte: {
@@ -32,7 +64,7 @@ namespace nbt {
             writer << std::get<double>(m_value);
         } break;
         case TagID::String: {
-            writer.writeStr(std::get<std::string>(m_value));
+            writer.writeStr(std::get<std::pmr::string>(m_value));
         } break;
         default: {
             std::cerr << std::format("[nbtpp] Invalid type {} for SimpleValue!", static_cast<int>(id)) << std::endl;
@@ -40,35 +72,50 @@ namespace nbt {
         }
     }
 
+    void SimpleValue::serialize(StreamWriter& writer) const {
+        encode(writer);
+    }
+
     void SimpleValue::deserialize(StreamReader& reader, TagID id) {
+        decode<true>(reader, id);
+    }
+
+    template <bool Checked, Encoding E>
+    void SimpleValue::decode(BasicStreamReader<E>& reader, TagID id, size_t depth) {
         switch (id) {
         case TagID::Byte: {
-            m_value = reader.read<char>();
+            m_value = detail::read<Checked, char>(reader);
         } break;
         case TagID::Short: {
-            m_value = reader.read<short>();
+            m_value = detail::read<Checked, short>(reader);
         } break;
         case TagID::Int: {
-            m_value = reader.read<int>();
+            m_value = detail::read<Checked, int>(reader);
         } break;
         case TagID::Long: {
-            m_value = reader.read<long long>();
+            m_value = detail::read<Checked, long long>(reader);
         } break;
         case TagID::Float: {
-            m_value = reader.read<float>();
+            m_value = detail::read<Checked, float>(reader);
         } break;
         case TagID::Double: {
-            m_value = reader.read<double>();
+            m_value = detail::read<Checked, double>(reader);
         } break;
         case TagID::String: {
-            m_value = reader.readStr();
+            m_value.emplace<std::pmr::string>(Checked ? reader.readStrView() : reader.readStrViewUnchecked(), m_resource);
         } break;
         default: {
-            std::cerr << std::format("[nbtpp] Invalid type {} for SimpleValue!", static_cast<int>(id)) << std::endl;
+            throw std::runtime_error(std::format("Invalid type {} for SimpleValue", static_cast<int>(id)));
         } break;
         }
     }
 
+    size_t SimpleValue::serializedSize() const {
+        if (auto str = std::get_if<std::pmr::string>(&m_value))
+            return 2 + str->size();
+        return fixedPayloadSize(getID());
+    }
+
     TagID SimpleValue::getID() const {
         if (std::holds_alternative<char>(m_value)) {
             return TagID::Byte;
@@ -82,7 +129,7 @@ namespace nbt {
             return TagID::Float;
         } else if (std::holds_alternative<double>(m_value)) {
             return TagID::Double;
-        } else if (std::holds_alternative<std::string>(m_value)) {
+        } else if (std::holds_alternative<std::pmr::string>(m_value)) {
             return TagID::String;
         } else {
             std::cerr << std::format("[nbtpp] Unknown type of a SimpleValue!") << std::endl;
@@ -90,23 +137,250 @@ namespace nbt {
         }
     }
 
-    ListValue::ListValue(TagID itemsID) : m_itemsID(itemsID) {}
+    ListValue::ListValue(TagID itemsID, std::pmr::memory_resource* resource)
+        : Value(resource), m_items(resource), m_itemsID(itemsID) {
+        unbox();
+    }
 
-    ListValue::ListValue(TagID itemsID, std::initializer_list<Value*> items) : m_itemsID(itemsID), m_items(items) {}
+    ListValue::ListValue(TagID itemsID, std::initializer_list<Value*> items, std::pmr::memory_resource* resource)
+        : Value(resource), m_items(items, resource), m_itemsID(itemsID) {
+        unbox();
+    }
 
     ListValue::~ListValue() {
-        for (auto val : m_items) {
-            if (val)
-                delete val;
+        if (isArenaOwned())
+            return;
+
+        for (auto val : m_items)
+            Value::release(val);
+    }
+
+    Value* ListValue::clone() const {
+        auto copy = makeValue<ListValue>(heapResource(), m_itemsID);
+        std::visit(
+            [&](const auto& numbers) {
+                using Storage = std::decay_t<decltype(numbers)>;
+                if constexpr (std::is_same_v<Storage, std::monostate>)
+                    copy->m_numbers = std::monostate {};
+                else
+                    copy->m_numbers.emplace<Storage>(numbers.begin(), numbers.end(), heapResource());
+            },
+            m_numbers);
+        copy->m_items.assign(m_items.begin(), m_items.end());
+        // the items of a Document die with it, a heap copy can't share them
+        for (auto& val : copy->m_items) {
+            if (isArenaOwned())
+                val = val->clone();
+            else
+                val->retain();
         }
+        return copy;
     }
 
-    void ListValue::serialize(StreamWriter& writer) const {
-        writer << m_itemsID << static_cast<unsigned int>(m_items.size());
+    Value* ListValue::edit(size_t index) {
+        auto& val = getItems().at(index);
+        if (val->isShared()) {
+            auto copy = val->clone();
+            Value::release(val);
+            val = copy;
+        }
+        return val;
+    }
+
+    template <typename T>
+    static bool unboxItems(std::pmr::vector<Value*>& items, std::pmr::vector<T>& out) {
+        for (auto val : items) {
+            if (!val || val->getID() != scalarTagID<T>())
+                return false;
+        }
+
+        out.reserve(out.size() + items.size());
+        for (auto val : items) {
+            out.push_back(std::get<T>(static_cast<SimpleValue*>(val)->get()));
+            Value::release(val);
+        }
+        items.clear();
+        return true;
+    }
+
+    template <typename T>
+    static bool unboxInto(std::pmr::vector<Value*>& items, ListValue::NumberStorage& numbers, std::pmr::memory_resource* resource) {
+        if (numbers.index() == 0) {
+            auto storage = std::pmr::vector<T>(resource);
+            if (!unboxItems(items, storage))
+                return false;
+            numbers = std::move(storage);
+            return true;
+        }
+        return unboxItems(items, std::get<std::pmr::vector<T>>(numbers));
+    }
+
+    bool ListValue::unbox() {
+        switch (m_itemsID) {
+        case TagID::Byte:
+            return unboxInto<char>(m_items, m_numbers, m_resource);
+        case TagID::Short:
+            return unboxInto<short>(m_items, m_numbers, m_resource);
+        case TagID::Int:
+            return unboxInto<int>(m_items, m_numbers, m_resource);
+        case TagID::Long:
+            return unboxInto<long long>(m_items, m_numbers, m_resource);
+        case TagID::Float:
+            return unboxInto<float>(m_items, m_numbers, m_resource);
+        case TagID::Double:
+            return unboxInto<double>(m_items, m_numbers, m_resource);
+        default:
+            return false;
+        }
+    }
+
+    void ListValue::unboxAs(TagID id) {
+        if (m_itemsID != id) {
+            if (length() || (m_itemsID != TagID::End && m_itemsID != TagID::None))
+                throw std::runtime_error(std::format("A list of tag {} can not be accessed as numbers of tag {}",
+                                                     static_cast<int>(m_itemsID), static_cast<int>(id)));
+            m_itemsID = id;
+            m_numbers = std::monostate {};
+        }
+
+        if (!unbox())
+            throw std::runtime_error("The list contains values which do not match its items tag");
+    }
+
+    void ListValue::box() {
+        std::visit(
+            [&](auto& numbers) {
+                if constexpr (!std::is_same_v<std::decay_t<decltype(numbers)>, std::monostate>) {
+                    m_items.reserve(m_items.size() + numbers.size());
+                    for (auto val : numbers)
+                        m_items.push_back(makeValue<SimpleValue>(m_resource, val));
+                }
+            },
+            m_numbers);
+        m_numbers = std::monostate {};
+    }
+
+    std::pmr::vector<Value*>& ListValue::getItems() {
+        // boxing replaces the storage another tree may be reading, e.g. a snapshot serialized by a worker
+        if (isShared()) {
+            if (isUnboxed())
+                throw std::runtime_error("A shared list can not be boxed, read it through the const getItems() or edit a copy of it");
+            return m_items;
+        }
+        markDirty();
+        if (isUnboxed())
+            box();
+        return m_items;
+    }
+
+    size_t ListValue::length() const {
+        return std::visit(
+            [&](const auto& numbers) {
+                if constexpr (std::is_same_v<std::decay_t<decltype(numbers)>, std::monostate>)
+                    return m_items.size();
+                else
+                    return numbers.size();
+            },
+            m_numbers);
+    }
+
+    // numeric lists which got boxed by getItems() are converted in chunks through the bulk byte swap
+    static constexpr size_t scalarChunkSize = 256;
+
+    template <typename T, Encoding E>
+    static void writeScalarList(BasicStreamWriter<E>& writer, const std::pmr::vector<Value*>& items) {
+        [[maybe_unused]] auto start = writer.size();
+        T chunk[scalarChunkSize];
+        for (size_t done = 0; done < items.size();) {
+            auto count = std::min(scalarChunkSize, items.size() - done);
+            for (size_t i = 0; i < count; i++)
+                chunk[i] = std::get<T>(static_cast<SimpleValue*>(items[done + i])->get());
+            writer.writeArray(std::span<const T>(chunk, count));
+            done += count;
+        }
+        detail::countTags(scalarTagID<T>(), items.size(), writer.size() - start);
+    }
+
+    // Java goes through the virtual serialize, which subclasses may override; the other encodings dispatch on the tag
+    template <Encoding E>
+    static void encodePayload(BasicStreamWriter<E>& writer, const Value* val) {
+        if constexpr (E == Encoding::Java) {
+            val->serialize(writer);
+        } else {
+            switch (val->getID()) {
+            case TagID::List:
+                return static_cast<const ListValue*>(val)->encode(writer);
+            case TagID::Compound:
+                return static_cast<const CompoundValue*>(val)->encode(writer);
+            case TagID::ByteArray:
+                return static_cast<const ByteArrayValue*>(val)->encode(writer);
+            case TagID::IntArray:
+                return static_cast<const IntArrayValue*>(val)->encode(writer);
+            case TagID::LongArray:
+                return static_cast<const LongArrayValue*>(val)->encode(writer);
+            default:
+                return static_cast<const SimpleValue*>(val)->encode(writer);
+            }
+        }
+    }
+
+    template <Encoding E>
+    static void encodeValue(BasicStreamWriter<E>& writer, const Value* val) {
+        // getID is virtual, it is only called when it is needed
+        if constexpr (StatsEnabled) {
+            auto counter = detail::TagCounter(val->getID(), writer.size());
+            encodePayload(writer, val);
+            counter.done(writer.size());
+        } else {
+            encodePayload(writer, val);
+        }
+    }
+
+    template <Encoding E>
+    void ListValue::encode(BasicStreamWriter<E>& writer) const {
+        // the source payload is Java data
+        if (E == Encoding::Java && isClean())
+            return writer.writeRaw(m_source);
+
+        writer << m_itemsID << static_cast<unsigned int>(length());
+
+        if (isUnboxed()) {
+            std::visit(
+                [&](const auto& numbers) {
+                    if constexpr (!std::is_same_v<std::decay_t<decltype(numbers)>, std::monostate>) {
+                        [[maybe_unused]] auto start = writer.size();
+                        writer.writeArray(std::span(numbers.data(), numbers.size()));
+                        detail::countTags(m_itemsID, numbers.size(), writer.size() - start);
+                    }
+                },
+                m_numbers);
+            return;
+        }
+
+        if (fixedPayloadSize(m_itemsID) &&
+            std::all_of(m_items.begin(), m_items.end(), [&](Value* val) { return val->getID() == m_itemsID; })) {
+            switch (m_itemsID) {
+            case TagID::Byte:
+                return writeScalarList<char>(writer, m_items);
+            case TagID::Short:
+                return writeScalarList<short>(writer, m_items);
+            case TagID::Int:
+                return writeScalarList<int>(writer, m_items);
+            case TagID::Long:
+                return writeScalarList<long long>(writer, m_items);
+            case TagID::Float:
+                return writeScalarList<float>(writer, m_items);
+            case TagID::Double:
+                return writeScalarList<double>(writer, m_items);
+            default:
+                break;
+            }
+        }
+
         for (const auto& val : m_items) {
             auto valID = val->getID();
             if (valID == m_itemsID) {
-                val->serialize(writer);
+                encodeValue(writer, val);
             } else {
                 std::cerr << std::format("[nbtpp] Failed to serialize a value (id {}) of the ListValue (should be {})",
                                          static_cast<int>(valID), static_cast<int>(m_itemsID))
@@ -115,50 +389,247 @@ namespace nbt {
         }
     }
 
+    void ListValue::serialize(StreamWriter& writer) const {
+        encode(writer);
+    }
+
+    size_t ListValue::serializedSize() const {
+        if (isClean())
+            return m_source.size();
+
+        size_t size = 1 + 4;
+        if (auto itemSize = fixedPayloadSize(m_itemsID))
+            return size + length() * itemSize;
+
+        for (const auto& val : m_items)
+            size += val->serializedSize();
+        return size;
+    }
+
+    template <bool Checked, typename T, Encoding E>
+    static void readScalarList(BasicStreamReader<E>& reader, size_t len, ListValue::NumberStorage& numbers, std::pmr::memory_resource* resource) {
+        [[maybe_unused]] auto start = reader.consumed();
+        detail::readArray<Checked>(reader, numbers.emplace<std::pmr::vector<T>>(resource), len);
+        detail::countTags(scalarTagID<T>(), len, reader.consumed() - start);
+    }
+
+    template <bool Checked, Encoding E>
+    static Value* decodeValue(BasicStreamReader<E>& reader, TagID id, std::pmr::memory_resource* resource, KeyTable& keys, size_t depth);
+
+    template <Encoding E>
+    [[noreturn]] static void throwMalformed(const BasicStreamReader<E>& reader, std::string_view message) {
+        if (reader.isStreaming())
+            throw std::runtime_error(std::string(message));
+        throw std::runtime_error(std::format("{} at offset {}", message, reader.offset()));
+    }
+
     void ListValue::deserialize(StreamReader& reader, TagID id) {
-        reader >> m_itemsID;
-        auto len = reader.read<unsigned int>();
+        decode<true>(reader, id);
+    }
+
+    template <bool Checked, Encoding E>
+    void ListValue::decode(BasicStreamReader<E>& reader, TagID id, size_t depth) {
+        auto start = reader.remaining().data();
+        m_itemsID = detail::read<Checked, TagID>(reader);
+        auto len = detail::read<Checked, uint32_t>(reader);
         m_items.clear();
-        m_items.resize(len);
-        for (auto& val : m_items) {
-            val = valueForID(reader, m_itemsID);
+        m_numbers = std::monostate {};
+
+        if constexpr (Checked) {
+            if (depth >= MaxDepth)
+                throwMalformed(reader, std::format("Nesting deeper than {}", MaxDepth));
+            if (m_itemsID == TagID::End && len)
+                throwMalformed(reader, std::format("List of End with {} items", len));
+            // every item takes at least one byte, a bogus length must not allocate anything
+            if (!reader.isStreaming() && len > reader.len())
+                throwMalformed(reader, std::format("List length {} exceeds the data", len));
+        }
+
+        switch (m_itemsID) {
+        case TagID::End:
+            break;
+        case TagID::Byte: {
+            readScalarList<Checked, char>(reader, len, m_numbers, m_resource);
+        } break;
+        case TagID::Short: {
+            readScalarList<Checked, short>(reader, len, m_numbers, m_resource);
+        } break;
+        case TagID::Int: {
+            readScalarList<Checked, int>(reader, len, m_numbers, m_resource);
+        } break;
+        case TagID::Long: {
+            readScalarList<Checked, long long>(reader, len, m_numbers, m_resource);
+        } break;
+        case TagID::Float: {
+            readScalarList<Checked, float>(reader, len, m_numbers, m_resource);
+        } break;
+        case TagID::Double: {
+            readScalarList<Checked, double>(reader, len, m_numbers, m_resource);
+        } break;
+        default: {
+            m_items.resize(len);
+            auto& keys = keyTableFor(m_resource);
+            for (auto& val : m_items) {
+                val = decodeValue<Checked>(reader, m_itemsID, m_resource, keys, depth + 1);
+            }
+        } break;
         }
+
+        if (E == Encoding::Java && reader.tracksSource())
+            m_source = {start, reader.remaining().data()};
     }
 
     void ListValue::appendValues(std::initializer_list<Value*> values) {
+        markDirty();
         m_items.insert(m_items.end(), values);
+        // stays unboxed when all the new values are numbers of the items tag
+        if (isUnboxed() && !unbox())
+            box();
     }
 
     CompoundValue::~CompoundValue() {
-        for (auto [_, val] : m_items) {
-            if (val)
-                delete val;
+        if (isArenaOwned())
+            return;
+
+        for (auto [_, val] : m_items)
+            Value::release(val);
+    }
+
+    CompoundValue::CompoundValue(const CompoundValue& other, std::pmr::memory_resource* resource)
+        : Value(resource), m_items(other.m_items, resource) {
+        // the children of a Document die with it, a heap copy can't share them
+        for (auto& [_, val] : m_items) {
+            if (other.isArenaOwned())
+                val = val->clone();
+            else
+                val->retain();
         }
     }
 
-    void CompoundValue::serialize(StreamWriter& writer) const {
+    Value* CompoundValue::clone() const {
+        detail::countAllocation(sizeof(CompoundValue));
+        return new CompoundValue(*this, heapResource());
+    }
+
+    CompoundValue CompoundValue::snapshot() const {
+        if (isArenaOwned())
+            throw std::runtime_error("Only trees on the heap can be shared, not the ones owned by a Document");
+        return CompoundValue(*this, heapResource());
+    }
+
+    Value* CompoundValue::edit(std::string_view key) {
+        auto it = m_items.find(key);
+        if (it == m_items.end())
+            return nullptr;
+
+        markDirty();
+        auto& val = it->second;
+        if (val->isShared()) {
+            auto copy = val->clone();
+            Value::release(val);
+            val = copy;
+        }
+        return val;
+    }
+
+    template <Encoding E>
+    void CompoundValue::encode(BasicStreamWriter<E>& writer) const {
+        // the source payload is Java data
+        if (E == Encoding::Java && isClean())
+            return writer.writeRaw(m_source);
+
         for (const auto& [name, val] : m_items) {
             writer << val->getID();
             writer.writeStr(name);
-            val->serialize(writer);
+            encodeValue(writer, val);
         }
         writer << TagID::End;
     }
 
+    void CompoundValue::serialize(StreamWriter& writer) const {
+        encode(writer);
+    }
+
+    size_t CompoundValue::serializedSize() const {
+        if (isClean())
+            return m_source.size();
+
+        size_t size = 1; // End tag
+        for (const auto& [name, val] : m_items)
+            size += 1 + 2 + name.size() + val->serializedSize();
+        return size;
+    }
+
     void CompoundValue::deserialize(StreamReader& reader, TagID id) {
+        decode<true>(reader, id);
+    }
+
+    template <bool Checked, Encoding E>
+    void CompoundValue::decode(BasicStreamReader<E>& reader, TagID id, size_t depth) {
+        if constexpr (Checked) {
+            if (depth >= MaxDepth)
+                throwMalformed(reader, std::format("Nesting deeper than {}", MaxDepth));
+        }
+
+        auto start = reader.remaining().data();
         while (true) {
-            auto tag = reader.read<TagID>();
+            auto tag = detail::read<Checked, TagID>(reader);
             if (tag == TagID::End) {
                 break;
             }
 
-            auto name = reader.readStr();
-            auto value = valueForID(reader, tag);
-            m_items[name] = value;
+            // the key has to be stored before the value is read, a streaming reader may reuse its buffer
+            auto [it, inserted] = m_items.emplace(Checked ? reader.readStrView() : reader.readStrViewUnchecked(), nullptr);
+            Value* value;
+            try {
+                value = decodeValue<Checked>(reader, tag, m_resource, m_items.keys(), depth + 1);
+            } catch (...) {
+                // what was read so far stays valid, e.g. the root of a Document
+                if (inserted)
+                    m_items.erase(it);
+                throw;
+            }
+            // a repeated key keeps the last value, like the game does
+            if (!inserted)
+                Value::release(it->second);
+            it->second = value;
+        }
+
+        if (E == Encoding::Java && reader.tracksSource())
+            m_source = {start, reader.remaining().data()};
+    }
+
+    Document::Document(size_t initialSize) : m_arena(initialSize) {
+        m_root = make<CompoundValue>();
+    }
+
+    void Document::reset() {
+        m_arena.release();
+        m_root = make<CompoundValue>();
+    }
+
+    template <bool Checked, typename T, Encoding E, typename... Args>
+    static Value* decodeNew(BasicStreamReader<E>& reader, TagID id, std::pmr::memory_resource* resource, size_t depth, Args&&... args) {
+        auto counter = detail::TagCounter(id, reader.consumed());
+        auto val = makeValue<T>(resource, std::forward<Args>(args)...);
+        if constexpr (Checked) {
+            // a value which fails halfway is not part of the tree yet, so nothing else would free it
+            try {
+                val->template decode<true>(reader, id, depth);
+            } catch (...) {
+                if (resource == heapResource())
+                    delete val;
+                throw;
+            }
+        } else {
+            val->template decode<false>(reader, id, depth);
         }
+        counter.done(reader.consumed());
+        return val;
     }
 
-    Value* valueForID(StreamReader& reader, TagID id) {
+    template <bool Checked, Encoding E>
+    static Value* decodeValue(BasicStreamReader<E>& reader, TagID id, std::pmr::memory_resource* resource, KeyTable& keys, size_t depth) {
         switch (id) {
         case TagID::Byte:
         case TagID::Short:
@@ -166,194 +637,460 @@ namespace nbt {
         case TagID::Long:
         case TagID::Float:
         case TagID::Double:
-        case TagID::String: {
-            auto val = new SimpleValue();
-            val->deserialize(reader, id);
-            return val;
-        } break;
-        case TagID::List: {
-            auto val = new ListValue(TagID::None);
-            val->deserialize(reader, id);
-            return val;
-        } break;
-        case TagID::Compound: {
-            auto val = new CompoundValue();
-            val->deserialize(reader, id);
-            return val;
-        } break;
-        case TagID::IntArray: {
-            auto val = new ArrayValue<int>();
-            val->deserialize(reader, id);
-            return val;
-        } break;
-        case TagID::ByteArray: {
-            auto val = new ArrayValue<char>();
-            val->deserialize(reader, id);
-            return val;
-        } break;
-        case TagID::LongArray: {
-            auto val = new ArrayValue<long long>();
-            val->deserialize(reader, id);
-            return val;
-        } break;
-        default: {
-            std::cerr << std::format("[nbtpp] Invalid tag {} in valueForID", static_cast<int>(id)) << std::endl;
-            return nullptr;
-        } break;
+        case TagID::String:
+            return decodeNew<Checked, SimpleValue>(reader, id, resource, depth);
+        case TagID::List:
+            return decodeNew<Checked, ListValue>(reader, id, resource, depth, TagID::None);
+        case TagID::Compound:
+            return decodeNew<Checked, CompoundValue>(reader, id, resource, depth, keys);
+        case TagID::IntArray:
+            return decodeNew<Checked, ArrayValue<int>>(reader, id, resource, depth);
+        case TagID::ByteArray:
+            return decodeNew<Checked, ArrayValue<char>>(reader, id, resource, depth);
+        case TagID::LongArray:
+            return decodeNew<Checked, ArrayValue<long long>>(reader, id, resource, depth);
+        default:
+            throwMalformed(reader, std::format("Invalid tag {}", static_cast<int>(id)));
         }
     }
 
-    CompoundValue loadFromBytes(std::span<uint8_t> bytes) {
+    template <Encoding E>
+    Value* valueForID(BasicStreamReader<E>& reader, TagID id, std::pmr::memory_resource* resource) {
+        return decodeValue<true>(reader, id, resource, keyTableFor(resource), 0);
+    }
+
+    template <bool Checked, Encoding E>
+    static void readRootImpl(BasicStreamReader<E>& r, CompoundValue& val) {
+        auto timer = detail::PhaseTimer(Phase::Parse);
+        auto counter = detail::TagCounter(TagID::Compound, r.consumed());
+        if (detail::read<Checked, TagID>(r) != TagID::Compound)
+            throwMalformed(r, "Root tag is not a compound");
+        // the name of the root, which is empty in practice
+        if constexpr (Checked)
+            r.readStrView();
+        else
+            r.readStrViewUnchecked();
+        val.decode<Checked>(r, TagID::Compound);
+        counter.done(r.consumed());
+    }
+
+    template <Encoding E>
+    void readRoot(BasicStreamReader<E>& r, CompoundValue& val) {
+        readRootImpl<true>(r, val);
+    }
+
+    template <Encoding E>
+    void writeRoot(BasicStreamWriter<E>& writer, const Value* val) {
+        auto timer = detail::PhaseTimer(Phase::Serialize);
+        auto counter = detail::TagCounter(TagID::Compound, writer.size());
+        writer << TagID::Compound;
+        writer.writeStr("");
+        encodeValue(writer, val);
+        counter.done(writer.size());
+    }
+
+    static MappedFile openFile(const std::string& path) {
+        auto timer = detail::PhaseTimer(Phase::Read);
+        return MappedFile(path);
+    }
+
+    static void validateUntrusted(std::span<const uint8_t> bytes, Trust trust, Encoding encoding = Encoding::Java) {
+        if (trust == Trust::Trusted)
+            return;
+        auto timer = detail::PhaseTimer(Phase::Parse);
+        if (auto valid = validate(bytes, encoding); !valid)
+            throw std::runtime_error(valid.error().describe());
+    }
+
+    void readRoot(std::span<uint8_t> bytes, CompoundValue& val, Trust trust, Encoding encoding) {
         if (!bytes.size() || !bytes.data()) {
             throw std::runtime_error("Invalid input data");
         }
 
+        validateUntrusted(bytes, trust, encoding);
+        visitEncoding(encoding, [&](auto e) {
+            auto r = BasicStreamReader<e.value>(bytes);
+            readRootImpl<false>(r, val);
+        });
+    }
+
+    CompoundValue loadFromBytes(std::span<uint8_t> bytes, Trust trust, Encoding encoding) {
+        auto stats = detail::CallStats("loadFromBytes");
         CompoundValue val;
-        auto r = StreamReader(bytes);
-        r.skip(3); // 0x0A 0x00 0x00: root compound tag which is not closed for some reason
-        val.deserialize(r, TagID::Compound);
+        readRoot(bytes, val, trust, encoding);
         return val;
     }
 
-    CompoundValue loadFromFile(const std::string& path) {
-        std::ifstream fileStream(path, std::ios::binary);
-        if (!fileStream) {
-            throw std::runtime_error(std::format("Failed to open file \"{}\"", path));
-        }
+    CompoundValue loadFromFile(const std::string& path, Trust trust, Encoding encoding) {
+        auto stats = detail::CallStats("loadFromFile");
+        // parse straight from the page cache instead of copying the file into memory first
+        auto file = openFile(path);
 
-        auto beg = fileStream.tellg();
-        fileStream.seekg(0, std::ios::end);
-        auto len = fileStream.tellg() - beg;
-        fileStream.seekg(0, std::ios::beg);
+        CompoundValue val;
+        readRoot(file.bytes(), val, trust, encoding);
+        return val;
+    }
 
-        auto buf = new char[len];
-        fileStream.read(buf, len);
+    static void readCompressed(std::span<uint8_t> bytes, CompoundValue& val, Encoding encoding) {
+        auto format = detectCompression(bytes);
+        if (format == Compression::None)
+            return readRoot(bytes, val, Trust::Untrusted, encoding);
 
-        fileStream.close();
+        auto& backend = backendFor(format);
+        if (backend.canStream(format)) {
+            // decompress while parsing, neither the compressed nor the uncompressed data is ever fully in memory
+            auto source = backend.stream(bytes, format);
+            visitEncoding(encoding, [&](auto e) {
+                auto r = BasicStreamReader<e.value>(*source);
+                readRoot(r, val);
+            });
+        } else {
+            std::vector<uint8_t> raw;
+            {
+                auto timer = detail::PhaseTimer(Phase::Inflate);
+                raw = backend.decompress(bytes, format);
+            }
+            readRoot(raw, val, Trust::Untrusted, encoding);
+        }
+    }
 
+    CompoundValue loadFromCompressedFile(const std::string& path, Encoding encoding) {
+        auto stats = detail::CallStats("loadFromCompressedFile");
+        auto file = openFile(path);
         CompoundValue val;
-        auto r = StreamReader({(uint8_t*)buf, static_cast<size_t>(len)});
-        r.skip(3); // 0x0A 0x00 0x00: root compound tag which is not closed for some reason
-        val.deserialize(r, TagID::Compound);
+        readCompressed(file.bytes(), val, encoding);
+        return val;
+    }
 
-        delete[] buf;
+    CompoundValue& loadFromBytes(std::span<uint8_t> bytes, Document& doc, Trust trust, Encoding encoding) {
+        auto stats = detail::CallStats("loadFromBytes");
+        doc.reset();
+        readRoot(bytes, doc.root(), trust, encoding);
+        return doc.root();
+    }
 
-        return val;
+    CompoundValue& loadFromFile(const std::string& path, Document& doc, Trust trust, Encoding encoding) {
+        auto stats = detail::CallStats("loadFromFile");
+        auto file = openFile(path);
+        return loadFromBytes(file.bytes(), doc, trust, encoding);
+    }
+
+    CompoundValue& loadFromCompressedFile(const std::string& path, Document& doc, Encoding encoding) {
+        auto stats = detail::CallStats("loadFromCompressedFile");
+        auto file = openFile(path);
+        doc.reset();
+        readCompressed(file.bytes(), doc.root(), encoding);
+        return doc.root();
     }
 
-    CompoundValue loadFromCompressedFile(const std::string& path) {
-#ifdef nbtpp_zlib
-        std::ifstream fileStream(path, std::ios::binary);
-        if (!fileStream)
-            throw std::runtime_error("Failed to open input file");
+    CompoundValue loadFromSource(StreamSource& source, Encoding encoding) {
+        auto stats = detail::CallStats("loadFromSource");
+        CompoundValue val;
+        visitEncoding(encoding, [&](auto e) {
+            auto r = BasicStreamReader<e.value>(source);
+            readRoot(r, val);
+        });
+        return val;
+    }
 
-        auto beg = fileStream.tellg();
-        fileStream.seekg(0, std::ios::end);
-        auto len = fileStream.tellg() - beg;
-        fileStream.seekg(0, std::ios::beg);
+    CompoundValue& loadFromSource(StreamSource& source, Document& doc, Encoding encoding) {
+        auto stats = detail::CallStats("loadFromSource");
+        doc.reset();
+        visitEncoding(encoding, [&](auto e) {
+            auto r = BasicStreamReader<e.value>(source);
+            readRoot(r, doc.root());
+        });
+        return doc.root();
+    }
 
-        auto source = std::make_unique<char[]>(len);
-        fileStream.read(source.get(), len);
-        fileStream.close();
+    CompoundValue& loadForEditing(std::span<const uint8_t> bytes, Document& doc, Trust trust) {
+        auto stats = detail::CallStats("loadForEditing");
+        if (!bytes.size() || !bytes.data()) {
+            throw std::runtime_error("Invalid input data");
+        }
 
-        z_stream strm {};
-        strm.next_in = (Bytef*)source.get();
-        strm.avail_in = len;
-        strm.zalloc = Z_NULL;
-        strm.zfree = Z_NULL;
+        validateUntrusted(bytes, trust);
+        doc.reset();
+        // the tree points into this copy, which lives exactly as long as the tree does
+        auto copy = (uint8_t*)doc.getResource()->allocate(bytes.size(), 1);
+        memcpy(copy, bytes.data(), bytes.size());
 
-        bool done = false;
+        auto r = StreamReader({copy, bytes.size()});
+        r.setTrackSource(true);
+        readRootImpl<false>(r, doc.root());
+        return doc.root();
+    }
 
-        if (inflateInit2(&strm, (16 + MAX_WBITS)) != Z_OK)
-            throw std::runtime_error("Failed to create a zlib stream");
+    CompoundValue& loadForEditing(StreamSource& source, Document& doc) {
+        auto stats = detail::CallStats("loadForEditing");
+        std::vector<uint8_t> bytes;
+        size_t len = 0;
+        while (true) {
+            bytes.resize(std::max<size_t>(len * 2, source.windowSize()));
+            auto timer = detail::PhaseTimer(Phase::Inflate);
+            auto got = source.produce(std::span(bytes).subspan(len));
+            if (!got)
+                break;
+            len += got;
+        }
+        bytes.resize(len);
 
-        std::string uncomp;
+        return loadForEditing(bytes, doc);
+    }
 
-        while (!done) {
-            auto avail = std::min(strm.avail_in, 1024u * 8u);
-            auto prevSize = uncomp.size();
-            uncomp.resize(prevSize + avail);
+    void saveToFile(const std::string& path, const Value* val, Encoding encoding) {
+        auto stats = detail::CallStats("saveToFile");
+        writeFileAtomically(path, saveToBytes(val, encoding));
+    }
 
-            strm.next_out = (Bytef*)(uncomp.data() + prevSize);
-            strm.avail_out = avail;
+    void saveToCompressedFile(const std::string& path, const Value* val, Compression format, int level, Encoding encoding) {
+        auto stats = detail::CallStats("saveToCompressedFile");
+        writeFileAtomically(path, compressData(saveToBytes(val, encoding), format, level));
+    }
 
-            auto code = inflate(&strm, Z_SYNC_FLUSH);
-            if (code == Z_STREAM_END)
-                done = true;
-            else if (code != Z_OK)
-                throw std::runtime_error(std::format("Zlib error while decompressing (code {})", code));
-        }
+    std::vector<uint8_t> saveToBytes(const Value* val, Encoding encoding) {
+        auto stats = detail::CallStats("saveToBytes");
+        return visitEncoding(encoding, [&](auto e) {
+            auto w = BasicStreamWriter<e.value>();
+            // exact for the fixed-width encodings, a close guess for the network one
+            w.reserve(3 + val->serializedSize());
+            writeRoot(w, val);
+            return w.takeBytes();
+        });
+    }
 
-        inflateEnd(&strm);
+    size_t savedSize(const Value* val, Encoding encoding) {
+        if (encoding == Encoding::Network)
+            return saveToBytes(val, encoding).size();
+        return 3 + val->serializedSize();
+    }
 
-        return loadFromBytes({(uint8_t*)uncomp.data(), uncomp.size()});
-#else
-        throw std::runtime_error("Compile nbtpp with zlib!");
-#endif
+    size_t saveToBytes(const Value* val, std::span<uint8_t> buffer, Encoding encoding) {
+        auto stats = detail::CallStats("saveToBytes");
+        return visitEncoding(encoding, [&](auto e) {
+            auto w = BasicStreamWriter<e.value>(buffer);
+            writeRoot(w, val);
+            return w.size();
+        });
     }
 
-    void saveToFile(const std::string& path, Value* val) {
-        auto f = std::ofstream(path, std::ios::binary | std::ios::trunc);
-        if (!f) {
-            throw std::runtime_error(std::format("Failed to open file \"{}\" for saving", path));
+    // Splits a tree into parts of about `grain` bytes at known offsets of the output, so they can be encoded into
+    // disjoint regions of one presized buffer concurrently. Only fixed-width encodings, where serializedSize is exact.
+    template <Encoding E>
+    class ParallelEncoder {
+      public:
+        ParallelEncoder(size_t grain) : m_grain(grain) {}
+
+        // plans the payload of the root compound at `offset`, returns its size; false from isSplittable means the
+        // tree can only be written serially
+        size_t plan(const Value* root, size_t offset) { return planValue(root, offset); }
+        inline bool isSplittable() const { return m_splittable && !m_parts.empty(); }
+
+        void write(std::span<uint8_t> buffer, ThreadPool& pool) {
+            // largest parts first, so no big one is left for the end
+            std::sort(m_parts.begin(), m_parts.end(), [](const Part& a, const Part& b) { return a.size > b.size; });
+            // every slot counts into its own stats, the caller's scope (slot 0 runs on its thread) gets the others after
+            auto caller = detail::currentStats();
+            std::vector<Stats> slotStats(caller ? pool.size() + 1 : 0);
+            pool.parallelFor(m_parts.size(), [&](size_t slot, size_t i) {
+                auto scope = std::optional<StatsScope>();
+                if (caller && slot)
+                    scope.emplace(slotStats[slot]);
+                auto& part = m_parts[i];
+                auto writer = BasicStreamWriter<E>(buffer.subspan(part.offset, part.size));
+                writePart(writer, part);
+                if (writer.size() != part.size)
+                    throw std::runtime_error("A value wrote a different number of bytes than its serializedSize");
+            });
+            for (auto& stats : slotStats)
+                caller->merge(stats);
         }
 
-        auto w = StreamWriter();
-        w.writeRaw({0x0A, 0x00, 0x00}); // root compound tag which is not closed for some reason
-        val->serialize(w);
+      private:
+        enum class PartKind {
+            Entries, // compound entries [first, last)
+            Tail,    // the same, followed by the End tag
+            Key,     // the tag and the key of entry `first`, its payload is split further
+            ListHeader,
+            Items // list items [first, last)
+        };
 
-        const auto& bytes = w.getBytes();
-        f.write((char*)bytes.data(), bytes.size());
-        f.close();
-    }
+        struct Part {
+            PartKind kind;
+            const Value* parent;
+            size_t first, last;
+            size_t offset, size;
+        };
+
+        // containers which get split further when they are large, anything else is encoded as a whole
+        // (subclasses may override serialize, so only the exact types; the tag is checked first, it is cheaper)
+        bool isSplittable(const Value* val) const {
+            auto id = val->getID();
+            if (id == TagID::Compound && typeid(*val) == typeid(CompoundValue))
+                return !(E == Encoding::Java && static_cast<const CompoundValue*>(val)->isClean());
+            if (id == TagID::List && typeid(*val) == typeid(ListValue)) {
+                auto list = static_cast<const ListValue*>(val);
+                return !(E == Encoding::Java && list->isClean()) && !list->isUnboxed() && !fixedPayloadSize(list->getItemsID());
+            }
+            return false;
+        }
 
-    void saveToCompressedFile(const std::string& path, Value* val) {
-#ifdef nbtpp_zlib
-        auto f = std::ofstream(path, std::ios::binary | std::ios::trunc);
-        if (!f) {
-            throw std::runtime_error("Failed to open output file for saving");
+        // the size of the value's payload at `offset`; a large splittable value leaves its parts in m_parts
+        size_t planValue(const Value* val, size_t offset) {
+            if (!isSplittable(val))
+                return val->serializedSize();
+
+            auto mark = m_parts.size();
+            auto size = val->getID() == TagID::Compound ? planCompound(static_cast<const CompoundValue*>(val), offset)
+                                                        : planList(static_cast<const ListValue*>(val), offset);
+            // small enough to be written by the part of its parent
+            if (size < m_grain)
+                m_parts.resize(mark);
+            return size;
         }
 
-        auto w = StreamWriter();
-        w.writeRaw({0x0A, 0x00, 0x00}); // root compound tag which is not closed for some reason
-        val->serialize(w);
-        const auto& bytes = w.getBytes();
+        size_t planCompound(const CompoundValue* val, size_t offset) {
+            auto& items = val->getItems();
+            auto pos = offset;
+            // consecutive small entries are written by one part
+            size_t runFirst = 0, runOffset = offset;
+            for (size_t i = 0; i < items.size(); i++) {
+                auto& [name, child] = *(items.begin() + i);
+                auto header = 1 + 2 + name.size();
+                auto size = planValue(child, pos + header);
 
-        auto srclen = bytes.size();
-        auto dstlen = compressBound(srclen);
+                if (size >= m_grain) {
+                    if (runFirst < i)
+                        m_parts.push_back({PartKind::Entries, val, runFirst, i, runOffset, pos - runOffset});
+                    if (isSplittable(child))
+                        m_parts.push_back({PartKind::Key, val, i, i + 1, pos, header});
+                    else
+                        m_parts.push_back({PartKind::Entries, val, i, i + 1, pos, header + size});
+                    runFirst = i + 1;
+                    runOffset = pos + header + size;
+                } else if (pos + header + size - runOffset >= m_grain) {
+                    m_parts.push_back({PartKind::Entries, val, runFirst, i + 1, runOffset, pos + header + size - runOffset});
+                    runFirst = i + 1;
+                    runOffset = pos + header + size;
+                }
+                pos += header + size;
+            }
+            // the rest and the End tag
+            m_parts.push_back({PartKind::Tail, val, runFirst, items.size(), runOffset, pos + 1 - runOffset});
+            return pos + 1 - offset;
+        }
 
-        auto dst = std::make_unique<char[]>(dstlen);
-        if (!dst)
-            throw std::runtime_error("Failed to create an output buffer");
+        size_t planList(const ListValue* val, size_t offset) {
+            auto& items = val->getItems();
+            m_parts.push_back({PartKind::ListHeader, val, 0, 0, offset, 1 + 4});
+            auto pos = offset + 1 + 4;
+            size_t runFirst = 0, runOffset = pos;
+            for (size_t i = 0; i < items.size(); i++) {
+                // encode skips such items with an error, the parts would leave a gap
+                if (items[i]->getID() != val->getItemsID())
+                    m_splittable = false;
 
-        z_stream strm {};
-        strm.next_in = (Bytef*)bytes.data();
-        strm.avail_in = bytes.size();
-        strm.next_out = (Bytef*)dst.get();
-        strm.avail_out = dstlen;
-        strm.zalloc = Z_NULL;
-        strm.zfree = Z_NULL;
+                auto size = planValue(items[i], pos);
+                if (size >= m_grain) {
+                    if (runFirst < i)
+                        m_parts.push_back({PartKind::Items, val, runFirst, i, runOffset, pos - runOffset});
+                    if (!isSplittable(items[i]))
+                        m_parts.push_back({PartKind::Items, val, i, i + 1, pos, size});
+                    runFirst = i + 1;
+                    runOffset = pos + size;
+                } else if (pos + size - runOffset >= m_grain) {
+                    m_parts.push_back({PartKind::Items, val, runFirst, i + 1, runOffset, pos + size - runOffset});
+                    runFirst = i + 1;
+                    runOffset = pos + size;
+                }
+                pos += size;
+            }
+            if (runFirst < items.size())
+                m_parts.push_back({PartKind::Items, val, runFirst, items.size(), runOffset, pos - runOffset});
+            return pos - offset;
+        }
 
-        if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 31, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
-            throw std::runtime_error("Failed to create a zlib stream");
+        // the same bytes CompoundValue::encode and ListValue::encode write for this range
+        static void writePart(BasicStreamWriter<E>& writer, const Part& part) {
+            switch (part.kind) {
+            case PartKind::Entries:
+            case PartKind::Tail: {
+                auto& items = static_cast<const CompoundValue*>(part.parent)->getItems();
+                for (auto it = items.begin() + part.first; it != items.begin() + part.last; ++it) {
+                    writer << it->second->getID();
+                    writer.writeStr(it->first);
+                    encodeValue(writer, it->second);
+                }
+                if (part.kind == PartKind::Tail)
+                    writer << TagID::End;
+            } break;
+            case PartKind::Key: {
+                auto& [name, val] = *(static_cast<const CompoundValue*>(part.parent)->getItems().begin() + part.first);
+                writer << val->getID();
+                writer.writeStr(name);
+            } break;
+            case PartKind::ListHeader: {
+                auto list = static_cast<const ListValue*>(part.parent);
+                writer << list->getItemsID() << static_cast<unsigned int>(list->length());
+            } break;
+            case PartKind::Items: {
+                auto& items = static_cast<const ListValue*>(part.parent)->getItems();
+                for (auto i = part.first; i < part.last; i++)
+                    encodeValue(writer, items[i]);
+            } break;
+            }
         }
 
-        deflate(&strm, Z_FINISH);
+        size_t m_grain;
+        bool m_splittable = true;
+        std::vector<Part> m_parts;
+    };
+
+    // both saveToBytesParallel overloads: `bufferFor(size)` provides the buffer once the size is known, nothing is
+    // returned if the tree is saved serially instead
+    template <typename BufferFor>
+    static std::optional<size_t> saveParallel(const Value* val, Encoding encoding, ThreadPool& pool, size_t grain, BufferFor bufferFor) {
+        if (encoding == Encoding::Network || pool.size() == 0)
+            return std::nullopt;
 
-        f.write(dst.get(), strm.total_out);
-        f.close();
+        return visitEncoding(encoding, [&](auto e) -> std::optional<size_t> {
+            // the root header: Compound tag and an empty name
+            constexpr size_t header = 1 + 2;
+            auto encoder = ParallelEncoder<e.value>(std::max<size_t>(grain, 1));
+            auto size = encoder.plan(val, header);
+            if (!encoder.isSplittable() || size < 2 * grain)
+                return std::nullopt;
+
+            auto timer = detail::PhaseTimer(Phase::Serialize);
+            std::span<uint8_t> bytes = bufferFor(header + size);
+            auto writer = BasicStreamWriter<e.value>(bytes.first(header));
+            writer << TagID::Compound;
+            writer.writeStr("");
+            encoder.write(bytes, pool);
+            return header + size;
+        });
+    }
 
-        deflateEnd(&strm);
-#else
-        throw std::runtime_error("Compile nbtpp with zlib!");
-#endif
+    std::vector<uint8_t> saveToBytesParallel(const Value* val, Encoding encoding, ThreadPool& pool, size_t grain) {
+        auto stats = detail::CallStats("saveToBytesParallel");
+        std::vector<uint8_t> bytes;
+        auto saved = saveParallel(val, encoding, pool, grain, [&](size_t size) {
+            bytes.resize(size);
+            return std::span(bytes);
+        });
+        if (!saved)
+            return saveToBytes(val, encoding);
+        return bytes;
     }
 
-    std::vector<uint8_t> saveToBytes(Value* val) {
-        auto w = StreamWriter();
-        w.writeRaw({0x0A, 0x00, 0x00}); // root compound tag which is not closed for some reason
-        val->serialize(w);
-        return w.getBytes();
+    size_t saveToBytesParallel(const Value* val, std::span<uint8_t> buffer, Encoding encoding, ThreadPool& pool, size_t grain) {
+        auto stats = detail::CallStats("saveToBytesParallel");
+        auto saved = saveParallel(val, encoding, pool, grain, [&](size_t size) {
+            if (buffer.size() < size)
+                throw std::runtime_error(std::format("Failed to write {} bytes into the buffer (only {} left)", size, buffer.size()));
+            return buffer.first(size);
+        });
+        return saved ? *saved : saveToBytes(val, buffer, encoding);
     }
 
     SimpleValue* Value::asSimple() {
@@ -361,20 +1098,59 @@ namespace nbt {
         if (tag >= TagID::Byte && tag <= TagID::Double || tag == TagID::String)
             return (SimpleValue*)this;
         else
-            throw new std::runtime_error("Failed to interpret as SimpleValue");
+            throw std::runtime_error("Failed to interpret as SimpleValue");
     }
 
     ListValue* Value::asList() {
         if (getID() == TagID::List)
             return (ListValue*)this;
         else
-            throw new std::runtime_error("Failed to interpret as ListValue");
+            throw std::runtime_error("Failed to interpret as ListValue");
     }
 
     CompoundValue* Value::asCompound() {
         if (getID() == TagID::Compound)
             return (CompoundValue*)this;
         else
-            throw new std::runtime_error("Failed to interpret as CompoundValue");
+            throw std::runtime_error("Failed to interpret as CompoundValue");
     }
+
+    template Value* valueForID(BasicStreamReader<Encoding::Java>&, TagID, std::pmr::memory_resource*);
+    template void readRoot(BasicStreamReader<Encoding::Java>&, CompoundValue&);
+    template void writeRoot(BasicStreamWriter<Encoding::Java>&, const Value*);
+    template void SimpleValue::decode<true>(BasicStreamReader<Encoding::Java>&, TagID, size_t);
+    template void SimpleValue::decode<false>(BasicStreamReader<Encoding::Java>&, TagID, size_t);
+    template void SimpleValue::encode(BasicStreamWriter<Encoding::Java>&) const;
+    template void ListValue::decode<true>(BasicStreamReader<Encoding::Java>&, TagID, size_t);
+    template void ListValue::decode<false>(BasicStreamReader<Encoding::Java>&, TagID, size_t);
+    template void ListValue::encode(BasicStreamWriter<Encoding::Java>&) const;
+    template void CompoundValue::decode<true>(BasicStreamReader<Encoding::Java>&, TagID, size_t);
+    template void CompoundValue::decode<false>(BasicStreamReader<Encoding::Java>&, TagID, size_t);
+    template void CompoundValue::encode(BasicStreamWriter<Encoding::Java>&) const;
+
+    template Value* valueForID(BasicStreamReader<Encoding::Bedrock>&, TagID, std::pmr::memory_resource*);
+    template void readRoot(BasicStreamReader<Encoding::Bedrock>&, CompoundValue&);
+    template void writeRoot(BasicStreamWriter<Encoding::Bedrock>&, const Value*);
+    template void SimpleValue::decode<true>(BasicStreamReader<Encoding::Bedrock>&, TagID, size_t);
+    template void SimpleValue::decode<false>(BasicStreamReader<Encoding::Bedrock>&, TagID, size_t);
+    template void SimpleValue::encode(BasicStreamWriter<Encoding::Bedrock>&) const;
+    template void ListValue::decode<true>(BasicStreamReader<Encoding::Bedrock>&, TagID, size_t);
+    template void ListValue::decode<false>(BasicStreamReader<Encoding::Bedrock>&, TagID, size_t);
+    template void ListValue::encode(BasicStreamWriter<Encoding::Bedrock>&) const;
+    template void CompoundValue::decode<true>(BasicStreamReader<Encoding::Bedrock>&, TagID, size_t);
+    template void CompoundValue::decode<false>(BasicStreamReader<Encoding::Bedrock>&, TagID, size_t);
+    template void CompoundValue::encode(BasicStreamWriter<Encoding::Bedrock>&) const;
+
+    template Value* valueForID(BasicStreamReader<Encoding::Network>&, TagID, std::pmr::memory_resource*);
+    template void readRoot(BasicStreamReader<Encoding::Network>&, CompoundValue&);
+    template void writeRoot(BasicStreamWriter<Encoding::Network>&, const Value*);
+    template void SimpleValue::decode<true>(BasicStreamReader<Encoding::Network>&, TagID, size_t);
+    template void SimpleValue::decode<false>(BasicStreamReader<Encoding::Network>&, TagID, size_t);
+    template void SimpleValue::encode(BasicStreamWriter<Encoding::Network>&) const;
+    template void ListValue::decode<true>(BasicStreamReader<Encoding::Network>&, TagID, size_t);
+    template void ListValue::decode<false>(BasicStreamReader<Encoding::Network>&, TagID, size_t);
+    template void ListValue::encode(BasicStreamWriter<Encoding::Network>&) const;
+    template void CompoundValue::decode<true>(BasicStreamReader<Encoding::Network>&, TagID, size_t);
+    template void CompoundValue::decode<false>(BasicStreamReader<Encoding::Network>&, TagID, size_t);
+    template void CompoundValue::encode(BasicStreamWriter<Encoding::Network>&) const;
 } // namespace nbt
@@ -1,69 +1,134 @@
 #pragma once
-#include <unordered_map>
 #include <variant>
 #include <string>
 #include <array>
 #include <memory>
+#include <memory_resource>
+#include <string_view>
+#include <atomic>
 
 #include "StreamReader.hpp"
 #include "StreamWriter.hpp"
+#include "Tags.hpp"
+#include "CompoundMap.hpp"
+#include "NbtView.hpp"
+#include "EventParser.hpp"
+#include "InflateSource.hpp"
+#include "MappedFile.hpp"
+#include "AtomicFile.hpp"
+#include "PathQuery.hpp"
+#include "Binding.hpp"
+#include "Validate.hpp"
+#include "Compression.hpp"
+#include "Snbt.hpp"
+#include "ThreadPool.hpp"
+#include "Stats.hpp"
 
 namespace nbt {
-    enum class TagID : uint8_t {
-        End = 0,
-        Byte,
-        Short,
-        Int,
-        Long,
-        Float,
-        Double,
-        ByteArray,
-        String,
-        List,
-        Compound,
-        IntArray,
-        LongArray,
-        None = 0xFF // custom
-    };
-
     class SimpleValue;
     class ListValue;
     template <typename T>
     class ArrayValue;
     class CompoundValue;
 
+    // resource used by nodes created with plain `new`; nodes built on any other resource are owned by it (see Document)
+    inline std::pmr::memory_resource* heapResource() {
+#ifdef nbtpp_stats
+        return detail::countingHeapResource();
+#else
+        return std::pmr::new_delete_resource();
+#endif
+    }
+
     class Value {
       public:
+        Value(std::pmr::memory_resource* resource = heapResource()) : m_resource(resource) {}
+        // a copy or a moved-to value has a single owner, whatever the count of the original is
+        Value(const Value& other) : m_resource(other.m_resource) {}
+        Value& operator=(const Value& other) {
+            m_resource = other.m_resource;
+            return *this;
+        }
         virtual ~Value() {}
 
         SimpleValue* asSimple();
         ListValue* asList();
         template <typename T>
         ArrayValue<T>* asArray() {
-            auto tag = getID();
-            if (tag == TagID::ByteArray || tag == TagID::IntArray || tag == TagID::LongArray)
+            constexpr auto id = std::is_same_v<T, char> ? TagID::ByteArray : std::is_same_v<T, int> ? TagID::IntArray : TagID::LongArray;
+            if (getID() == id)
                 return (ArrayValue<T>*)this;
             else
-                throw new std::runtime_error("Failed to interpret as ArrayValue");
+                throw std::runtime_error("Failed to interpret as ArrayValue");
         }
         CompoundValue* asCompound();
 
+        // writes the payload in the Java encoding, the values' encode() writes any encoding
         virtual void serialize(StreamWriter& writer) const = 0;
+        // reads the payload with every read checked, throws std::runtime_error on malformed data
         virtual void deserialize(StreamReader& reader, TagID id) = 0;
+        // exact number of bytes serialize() will write, which is the same in the Bedrock encoding
+        virtual size_t serializedSize() const = 0;
 
         virtual TagID getID() const { return TagID::None; }
+
+        inline std::pmr::memory_resource* getResource() const { return m_resource; }
+        // arena-owned nodes are never deleted individually, their memory is released together with the arena
+        inline bool isArenaOwned() const { return m_resource != heapResource(); }
+
+        // Heap values are reference-counted, so subtrees can be shared between trees (see CompoundValue::snapshot).
+        // Containers release their children instead of deleting them; a value taken out of a tree which may be
+        // shared has to be released the same way. A shared value must not be modified, get a private copy of it
+        // through the edit() of its parent first.
+        inline void retain() const { m_refs.fetch_add(1, std::memory_order_relaxed); }
+        // drops one owner, the last one deletes the value; does nothing for null and arena-owned values
+        static void release(Value* val);
+        inline bool isShared() const { return m_refs.load(std::memory_order_acquire) > 1; }
+        // A heap copy of this value alone: the children of a list or compound are shared with it, not copied (unless
+        // they are owned by a Document, then the whole subtree is).
+        // Subclasses have to override it to be edited in shared trees, the default throws.
+        virtual Value* clone() const;
+
+      protected:
+        std::pmr::memory_resource* m_resource;
+        mutable std::atomic<uint32_t> m_refs = 1;
     };
 
+    // allocates a value on the given resource, children of the value will be allocated on it too
+    template <typename T, typename... Args>
+    T* makeValue(std::pmr::memory_resource* resource, Args&&... args) {
+        if (resource == heapResource()) {
+            detail::countAllocation(sizeof(T));
+            return new T(std::forward<Args>(args)..., resource);
+        }
+
+        auto mem = resource->allocate(sizeof(T), alignof(T));
+        return new (mem) T(std::forward<Args>(args)..., resource);
+    }
+
     class SimpleValue : public Value {
       public:
-        using SimpleType = std::variant<char, short, int, long long, float, double, std::string>;
+        using SimpleType = std::variant<char, short, int, long long, float, double, std::pmr::string>;
 
-        SimpleValue() {};
-        SimpleValue(SimpleType value);
+        SimpleValue(std::pmr::memory_resource* resource = heapResource()) : Value(resource) {};
+        SimpleValue(SimpleType value, std::pmr::memory_resource* resource = heapResource());
+        SimpleValue(const char* value, std::pmr::memory_resource* resource = heapResource());
+        SimpleValue(std::string_view value, std::pmr::memory_resource* resource = heapResource());
 
         virtual void serialize(StreamWriter& writer) const override;
         virtual void deserialize(StreamReader& reader, TagID id) override;
+        virtual size_t serializedSize() const override;
         virtual TagID getID() const override;
+        virtual Value* clone() const override;
+
+        // Reads the payload, deserialize is decode<true> in the Java encoding. Without Checked nothing is
+        // bounds-checked, so the data has to be validated first (see validate). `depth` is the nesting of the value,
+        // for the depth limit.
+        template <bool Checked, Encoding E>
+        void decode(BasicStreamReader<E>& reader, TagID id, size_t depth = 0);
+        // writes the payload, serialize is encode in the Java encoding
+        template <Encoding E>
+        void encode(BasicStreamWriter<E>& writer) const;
 
         inline const SimpleType& get() const { return m_value; }
         inline void set(const SimpleType& val) { m_value = val; }
@@ -83,23 +148,76 @@ namespace nbt {
 
     class ListValue : public Value {
       public:
-        ListValue(TagID itemsID);
-        ListValue(TagID itemsID, std::initializer_list<Value*> items);
+        using NumberStorage = std::variant<std::monostate, std::pmr::vector<char>, std::pmr::vector<short>, std::pmr::vector<int>,
+                                           std::pmr::vector<long long>, std::pmr::vector<float>, std::pmr::vector<double>>;
+
+        ListValue(TagID itemsID, std::pmr::memory_resource* resource = heapResource());
+        ListValue(TagID itemsID, std::initializer_list<Value*> items, std::pmr::memory_resource* resource = heapResource());
+        ListValue(ListValue&& other) = default;
         ~ListValue() override;
 
         virtual void serialize(StreamWriter& writer) const override;
         virtual void deserialize(StreamReader& reader, TagID id) override;
+        virtual size_t serializedSize() const override;
         virtual TagID getID() const override { return TagID::List; }
+        virtual Value* clone() const override;
+
+        // see SimpleValue::decode and SimpleValue::encode
+        template <bool Checked, Encoding E>
+        void decode(BasicStreamReader<E>& reader, TagID id, size_t depth = 0);
+        template <Encoding E>
+        void encode(BasicStreamWriter<E>& writer) const;
         inline TagID getItemsID() const { return m_itemsID; }
 
-        inline std::vector<Value*>& getItems() { return m_items; }
+        // Lists of Byte, Short, Int, Long, Float or Double keep their items unboxed in a typed vector. getItems()
+        // boxes them into SimpleValues (and the list stays boxed), getNumbers() unboxes them again. Switching
+        // invalidates whatever the other accessor returned.
+        // Mutable access (getItems, getNumbers, appendValues) marks the list as modified, see isClean. A shared list
+        // is never boxed or unboxed, the accessor which would have to throws instead (see Value::isShared).
+        std::pmr::vector<Value*>& getItems();
         void appendValues(std::initializer_list<Value*> values);
+        // read-only access which neither boxes nor marks the list as modified: the boxed items (empty while the list
+        // is unboxed) and the typed storage (monostate while it is boxed)
+        inline const std::pmr::vector<Value*>& getItems() const { return m_items; }
+        inline const NumberStorage& getNumberStorage() const { return m_numbers; }
 
-        inline size_t length() const { return m_items.size(); }
+        // the item at `index` (boxing the list), copied first if it is shared with another tree; see Value::isShared
+        Value* edit(size_t index);
+
+        // typed storage of a numeric list, T has to match the items tag (an empty list of End takes the tag of T)
+        template <typename T>
+        std::pmr::vector<T>& getNumbers() {
+            constexpr auto id = scalarTagID<T>();
+            static_assert(id != TagID::None, "ListValue::getNumbers only supports numeric types");
+            if (isShared()) {
+                if (!isUnboxed() || m_itemsID != id)
+                    throw std::runtime_error("A shared list can not be unboxed, edit a copy of it");
+                return std::get<std::pmr::vector<T>>(m_numbers);
+            }
+            markDirty();
+            if (!isUnboxed() || m_itemsID != id)
+                unboxAs(id);
+            return std::get<std::pmr::vector<T>>(m_numbers);
+        }
+        inline bool isUnboxed() const { return m_numbers.index() != 0; }
+
+        size_t length() const;
+
+        // true while the list still holds the payload it was loaded from (see loadForEditing), which is then
+        // written back verbatim; call markDirty after changing items through a pointer kept from earlier
+        inline bool isClean() const { return m_source.data(); }
+        inline void markDirty() { m_source = {}; }
 
       protected:
-        std::vector<Value*> m_items;
+        // switches to the unboxed storage, false if some item does not match the items tag
+        bool unbox();
+        void unboxAs(TagID id);
+        void box();
+
+        std::pmr::vector<Value*> m_items;
+        NumberStorage m_numbers;
         TagID m_itemsID;
+        std::span<const uint8_t> m_source;
     };
 
     template <typename T>
@@ -108,35 +226,86 @@ namespace nbt {
                       "ArrayValue can only accept char, int or long long!");
 
       public:
-        ArrayValue() {}
-        ArrayValue(std::initializer_list<T> values) : m_items(values) {}
+        ArrayValue(std::pmr::memory_resource* resource = heapResource()) : Value(resource), m_items(resource) {}
+        ArrayValue(std::initializer_list<T> values, std::pmr::memory_resource* resource = heapResource())
+            : Value(resource), m_items(values, resource) {}
 
-        virtual void serialize(StreamWriter& writer) const override;
-        virtual void deserialize(StreamReader& reader, TagID id) override;
+        virtual void serialize(StreamWriter& writer) const override { encode(writer); }
+        virtual void deserialize(StreamReader& reader, TagID id) override { decode<true>(reader, id); }
+        virtual size_t serializedSize() const override { return 4 + m_items.size() * sizeof(T); }
         virtual TagID getID() const override;
+        virtual Value* clone() const override {
+            auto copy = makeValue<ArrayValue<T>>(heapResource());
+            copy->m_items.assign(m_items.begin(), m_items.end());
+            return copy;
+        }
+
+        // see SimpleValue::decode and SimpleValue::encode
+        template <bool Checked, Encoding E>
+        void decode(BasicStreamReader<E>& reader, TagID id, size_t depth = 0);
+        template <Encoding E>
+        void encode(BasicStreamWriter<E>& writer) const;
 
-        inline std::vector<T>& getItems() { return m_items; }
+        inline std::pmr::vector<T>& getItems() { return m_items; }
+        inline const std::pmr::vector<T>& getItems() const { return m_items; }
         inline size_t length() const { return m_items.size(); }
 
       protected:
-        std::vector<T> m_items;
+        std::pmr::vector<T> m_items;
     };
 
     class CompoundValue : public Value {
       public:
+        CompoundValue(std::pmr::memory_resource* resource = heapResource()) : Value(resource), m_items(resource) {}
+        // see CompoundMap, spares looking up the key table of the resource for every compound of a tree
+        CompoundValue(KeyTable& keys, std::pmr::memory_resource* resource) : Value(resource), m_items(keys, resource) {}
+        // values own their children, so they can only be moved
+        CompoundValue(CompoundValue&& other) = default;
         ~CompoundValue() override;
 
-        using CompoundValueType = std::unordered_map<std::string, Value*>;
+        // insertion-ordered, so a tree serializes back in the order it was read
+        using CompoundValueType = CompoundMap;
 
         virtual void serialize(StreamWriter& writer) const override;
         virtual void deserialize(StreamReader& reader, TagID id) override;
+        virtual size_t serializedSize() const override;
         virtual TagID getID() const override { return TagID::Compound; }
+        virtual Value* clone() const override;
+
+        // A snapshot of a heap tree in time proportional to the number of keys of this compound, not the size of the
+        // tree: the children are shared, see Value::retain. Reading both trees from different threads is safe as long
+        // as the tree which keeps being modified is only modified through edit(), which copies each shared value on
+        // the path to the modified one (and nothing else) before returning it.
+        CompoundValue snapshot() const;
+        // the value of `key` (nullptr if there is none), copied first if it is shared with another tree
+        Value* edit(std::string_view key);
+
+        // see SimpleValue::decode and SimpleValue::encode
+        template <bool Checked, Encoding E>
+        void decode(BasicStreamReader<E>& reader, TagID id, size_t depth = 0);
+        template <Encoding E>
+        void encode(BasicStreamWriter<E>& writer) const;
+
+        // marks the compound as modified (see isClean); the const overload keeps it clean, so nothing reached
+        // through it may be modified
+        inline CompoundValueType& getItems() {
+            markDirty();
+            return m_items;
+        }
+        inline const CompoundValueType& getItems() const { return m_items; }
+        inline bool hasKey(std::string_view key) const { return m_items.contains(key); }
 
-        inline CompoundValueType& getItems() { return m_items; }
-        inline bool hasKey(const std::string& key) { return m_items.contains(key); }
+        // true while the compound still holds the payload it was loaded from (see loadForEditing), which is then
+        // written back verbatim; call markDirty after changing values through a pointer kept from earlier
+        inline bool isClean() const { return m_source.data(); }
+        inline void markDirty() { m_source = {}; }
 
       protected:
+        // shares the children of other, or copies them if other is owned by a Document
+        CompoundValue(const CompoundValue& other, std::pmr::memory_resource* resource);
+
         CompoundValueType m_items;
+        std::span<const uint8_t> m_source;
     };
 
     using ByteArrayValue = ArrayValue<char>;
@@ -146,28 +315,41 @@ namespace nbt {
     using ValueType = std::variant<SimpleValue, ByteArrayValue, ListValue, CompoundValue, IntArrayValue, LongArrayValue>;
 
     template <typename T>
-    inline void ArrayValue<T>::serialize(StreamWriter& writer) const {
+    template <Encoding E>
+    inline void ArrayValue<T>::encode(BasicStreamWriter<E>& writer) const {
         writer << static_cast<unsigned int>(m_items.size());
-        if (getID() == TagID::ByteArray) {
-            writer.writeRaw({(uint8_t*)m_items.data(), m_items.size()});
-        } else {
-            for (const auto& val : m_items) {
-                writer << val;
-            }
-        }
+        writer.writeArray(std::span<const T>(m_items));
     }
 
-    template <typename T>
-    inline void ArrayValue<T>::deserialize(StreamReader& reader, TagID id) {
-        auto size = reader.read<unsigned int>();
-        m_items.resize(size);
-        if (id == TagID::ByteArray) {
-            reader.read({(uint8_t*)m_items.data(), size});
-        } else {
-            for (auto& val : m_items) {
-                reader >> val;
+    namespace detail {
+        template <bool Checked, typename T, Encoding E>
+        inline T read(BasicStreamReader<E>& reader) {
+            if constexpr (Checked)
+                return reader.template read<T>();
+            else
+                return reader.template readUnchecked<T>();
+        }
+
+        // a checked read makes sure the data is there before allocating for it
+        template <bool Checked, typename T, Encoding E>
+        inline void readArray(BasicStreamReader<E>& reader, std::pmr::vector<T>& items, size_t len) {
+            if constexpr (Checked) {
+                if (!reader.isStreaming())
+                    ensureAvailable(reader, len * minEncodedSize<E, T>());
+                items.resize(len);
+                if (!reader.readArray(std::span<T>(items)))
+                    throw std::runtime_error("Unexpected end of data");
+            } else {
+                items.resize(len);
+                reader.readArrayUnchecked(std::span<T>(items));
             }
         }
+    } // namespace detail
+
+    template <typename T>
+    template <bool Checked, Encoding E>
+    inline void ArrayValue<T>::decode(BasicStreamReader<E>& reader, TagID id, size_t depth) {
+        detail::readArray<Checked>(reader, m_items, detail::read<Checked, uint32_t>(reader));
     }
 
     template <typename T>
@@ -183,13 +365,97 @@ namespace nbt {
         }
     }
 
-    Value* valueForID(StreamReader& reader, TagID id);
+    // Owns a monotonic arena from which every node, interned key and array payload of a loaded tree is allocated.
+    // Nodes are never destroyed one by one, the whole tree is freed at once when the document is reset or destroyed.
+    class Document {
+      public:
+        Document(size_t initialSize = 64 * 1024);
+        Document(const Document&) = delete;
+        Document& operator=(const Document&) = delete;
+
+        inline CompoundValue& root() { return *m_root; }
+        inline std::pmr::memory_resource* getResource() { return &m_arena; }
+        // keys of the tree, interned once per document and freed with it
+        inline KeyTable& keys() { return m_arena.keys(); }
+
+        // creates a value owned by the document, use this instead of `new` when adding values to the tree
+        template <typename T, typename... Args>
+        T* make(Args&&... args) {
+            return makeValue<T>(&m_arena, std::forward<Args>(args)...);
+        }
 
-    CompoundValue loadFromBytes(std::span<uint8_t> bytes);
-    CompoundValue loadFromFile(const std::string& path);
-    CompoundValue loadFromCompressedFile(const std::string& path);
+        // frees everything at once and starts over with an empty root
+        void reset();
+
+      private:
+        KeyArena m_arena;
+        CompoundValue* m_root;
+    };
 
-    void saveToFile(const std::string& path, Value* val);
-    void saveToCompressedFile(const std::string& path, Value* val);
-    std::vector<uint8_t> saveToBytes(Value* val);
+    // Loads from memory (bytes, files and uncompressed chunks) validate the whole input in one pass first and then
+    // decode it without any per-read checks. Trusted skips the validation, only use it for data this program wrote
+    // itself: decoding malformed trusted data is undefined behavior. Streaming loads (compressed files, sources)
+    // check every read instead.
+    enum class Trust { Untrusted, Trusted };
+
+    // Every load and save takes the encoding of the data (see Encoding), Java by default. The tree itself does not
+    // depend on it, so a Bedrock file can be loaded and saved as Java or the other way around.
+
+    // allocates and reads a value of the given tag with every read checked
+    template <Encoding E>
+    Value* valueForID(BasicStreamReader<E>& reader, TagID id, std::pmr::memory_resource* resource = heapResource());
+    // reads a root compound (tag, name and payload) into val
+    template <Encoding E>
+    void readRoot(BasicStreamReader<E>& reader, CompoundValue& val);
+    void readRoot(std::span<uint8_t> bytes, CompoundValue& val, Trust trust = Trust::Untrusted, Encoding encoding = Encoding::Java);
+    // writes a root compound with an empty name, val has to be a compound
+    template <Encoding E>
+    void writeRoot(BasicStreamWriter<E>& writer, const Value* val);
+
+    CompoundValue loadFromBytes(std::span<uint8_t> bytes, Trust trust = Trust::Untrusted, Encoding encoding = Encoding::Java);
+    CompoundValue loadFromFile(const std::string& path, Trust trust = Trust::Untrusted, Encoding encoding = Encoding::Java);
+    // the format is detected (see detectCompression), uncompressed files load too; backends which can stream
+    // (zlib) decompress while parsing, the others decompress the whole file first and validate it like loadFromBytes
+    CompoundValue loadFromCompressedFile(const std::string& path, Encoding encoding = Encoding::Java);
+    // parses while the source produces the data, e.g. an InflateSource or an AsyncSource wrapping one
+    CompoundValue loadFromSource(StreamSource& source, Encoding encoding = Encoding::Java);
+
+    // arena-backed overloads, they reset the document and the returned root is only valid as long as it lives
+    CompoundValue& loadFromBytes(std::span<uint8_t> bytes, Document& doc, Trust trust = Trust::Untrusted,
+                                 Encoding encoding = Encoding::Java);
+    CompoundValue& loadFromFile(const std::string& path, Document& doc, Trust trust = Trust::Untrusted,
+                                Encoding encoding = Encoding::Java);
+    CompoundValue& loadFromCompressedFile(const std::string& path, Document& doc, Encoding encoding = Encoding::Java);
+    CompoundValue& loadFromSource(StreamSource& source, Document& doc, Encoding encoding = Encoding::Java);
+
+    // Loads a tree for editing: the bytes are copied into the document and every compound and list remembers the
+    // payload it was read from. Navigating with the non-const accessors marks the path as modified, so saving
+    // copies everything else verbatim and only re-encodes what was touched. Java only, saving such a tree in
+    // another encoding re-encodes all of it.
+    CompoundValue& loadForEditing(std::span<const uint8_t> bytes, Document& doc, Trust trust = Trust::Untrusted);
+    // reads the whole source first, e.g. an InflateSource for compressed files
+    CompoundValue& loadForEditing(StreamSource& source, Document& doc);
+
+    // Files are replaced atomically (see writeFileAtomically), a crash during a save keeps the previous file intact.
+    // AsyncSaver (AsyncSave.hpp) does the compression and the writing in the background.
+    void saveToFile(const std::string& path, const Value* val, Encoding encoding = Encoding::Java);
+    // gzip is what the game expects for level.dat and player data, see CompressionBackend for the levels
+    void saveToCompressedFile(const std::string& path, const Value* val, Compression format = Compression::Gzip,
+                              int level = DefaultLevel, Encoding encoding = Encoding::Java);
+    std::vector<uint8_t> saveToBytes(const Value* val, Encoding encoding = Encoding::Java);
+    // size of the data saveToBytes would produce (root header included), the network encoding has to encode the
+    // whole tree to find out
+    size_t savedSize(const Value* val, Encoding encoding = Encoding::Java);
+    // serializes into a caller-provided buffer, which has to be at least savedSize() long; returns the bytes written
+    size_t saveToBytes(const Value* val, std::span<uint8_t> buffer, Encoding encoding = Encoding::Java);
+    // Same output as saveToBytes, with large trees encoded on several threads: the tree is sized up front and split
+    // into parts of about `grain` bytes (runs of small siblings, large arrays, the frames of large containers),
+    // which are written into disjoint regions of one presized buffer. Trees under twice the grain, and the network
+    // encoding whose size is only known once it is encoded, are saved serially.
+    // The vector is zero-filled once before the threads write into it; the overload taking a buffer (at least
+    // savedSize() long, like the one of saveToBytes) skips that and returns the bytes written.
+    std::vector<uint8_t> saveToBytesParallel(const Value* val, Encoding encoding = Encoding::Java, ThreadPool& pool = ThreadPool::shared(),
+                                             size_t grain = 256 * 1024);
+    size_t saveToBytesParallel(const Value* val, std::span<uint8_t> buffer, Encoding encoding = Encoding::Java,
+                               ThreadPool& pool = ThreadPool::shared(), size_t grain = 256 * 1024);
 } // namespace nbt
\ No newline at end of file